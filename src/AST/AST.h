@@ -4,14 +4,27 @@
 #include <optional>
 
 #include "Util/token.h"
+#include "Util/symbol.h"
+#include "Util/source.h"
+#include "Util/array.h"
+#include "Util/struct.h"
 #include "Resolver/Module.h"
 
+// Where a variable lives at runtime. Assigned by the TypeChecker:
+// globals index the global table, locals index the current function's frame
+struct SlotRef {
+    uint32_t index = 0;
+    bool global = false;
+};
+
 struct LiteralExpr {
     RaftValue val;
 };
 
 struct VariableExpr {
-    std::string id;
+    Symbol id;
+    mutable SlotRef slot;
+    SourcePos pos = 0;
 };
 
 struct BinaryExpr;
@@ -23,6 +36,13 @@ struct ArrayExpr;
 struct IfExpr;
 struct BlockExpr;
 struct WhileExpr;
+struct ForExpr;
+struct LoopExpr;
+
+struct StructExpr;
+struct FieldExpr;
+
+struct MapExpr;
 
 struct CallExpr;
 
@@ -35,74 +55,181 @@ using Expr = std::variant<
     
     std::unique_ptr<IfExpr>,
     std::unique_ptr<BlockExpr>,
-    std::unique_ptr<WhileExpr>
+    std::unique_ptr<WhileExpr>,
+
+    std::unique_ptr<IndexExpr>,
+    std::unique_ptr<ArrayExpr>,
+
+    std::unique_ptr<ForExpr>,
+    std::unique_ptr<LoopExpr>,
+
+    std::unique_ptr<StructExpr>,
+    std::unique_ptr<FieldExpr>,
+
+    std::unique_ptr<MapExpr>
 >;
 
 struct BinaryExpr {
     TokenType op;
     Expr left;
     Expr right;
+    SourcePos pos = 0;
 };
 
 struct UnaryExpr {
     TokenType op;
     Expr operand;
+    SourcePos pos = 0;
+};
+
+// array[index]
+struct IndexExpr {
+    Expr array;
+    Expr index;
+    mutable bool checked = true; // Cleared by the TypeChecker when the index provably stays in bounds
+    SourcePos pos = 0;
+};
+
+// [a, b, c] or [fill; count]
+struct ArrayExpr {
+    std::vector<Expr> elements; // The fill value alone for [fill; count]
+    std::unique_ptr<Expr> count;
+    mutable ElementKind kind = ElementKind::Int; // Set by the TypeChecker
+    SourcePos pos = 0;
+};
+
+// Point { x: 1.0, y: 2.0 }: every field is given once, in any order
+struct StructExpr {
+    struct Field {
+        Symbol name;
+        Expr value;
+        mutable const StructLayout::Field* resolved = nullptr; // Set by the TypeChecker
+    };
+
+    Symbol name;
+    std::vector<Field> fields;
+    mutable const StructLayout* layout = nullptr; // Set by the TypeChecker
+    SourcePos pos = 0;
+};
+
+// object.field, where object is a struct
+struct FieldExpr {
+    Expr object;
+    Symbol field;
+    mutable const StructLayout::Field* resolved = nullptr; // Set by the TypeChecker
+    SourcePos pos = 0;
 };
 
+// Map<string, int> { "one": 1, "two": 2 }: a new map holding the entries, which may be none
+struct MapExpr {
+    struct Entry {
+        Expr key;
+        Expr value;
+    };
+
+    std::string type;
+    std::vector<Entry> entries;
+    mutable ElementKind keyKind = ElementKind::Int; // Set by the TypeChecker
+    mutable ElementKind valueKind = ElementKind::Int;
+    SourcePos pos = 0;
+};
+
+// name = value, or a compound assignment: += -= *= /=, and ++ and --, which are parsed as += 1
+// and -= 1 with op kept. Compound assignments update the variable where it is stored.
 struct AssignmentStmt {
-    std::string id;
+    Symbol id;
     Expr value;
     TokenType op;
+    mutable SlotRef slot;
+    SourcePos pos = 0;
+    mutable ElementKind kind = ElementKind::Int; // Set by the TypeChecker: the variable's type, for compound assignments
+};
+
+// name[index] = value
+struct IndexAssignStmt {
+    Symbol id;
+    Expr index;
+    Expr value;
+    mutable SlotRef slot;
+    mutable bool checked = true;
+    SourcePos pos = 0;
+};
+
+// name.a.b = value or name[index].a = value: a field of a struct variable, or of an element of a
+// struct array variable, is written in place
+struct FieldAssignStmt {
+    Symbol id;
+    std::unique_ptr<Expr> index; // Null unless the struct is an array element
+    std::vector<Symbol> fields;
+    Expr value;
+    mutable SlotRef slot;
+    mutable uint32_t offset = 0; // Of the last field from the start of the struct, summed by the TypeChecker
+    mutable const StructLayout::Field* resolved = nullptr; // The last field
+    mutable bool checked = true;
+    SourcePos pos = 0;
 };
 
 struct FunctionInfo;
 
 struct CallExpr {
-    std::vector<std::string> name_parts;
+    std::vector<Symbol> name_parts;
     std::vector<Expr> arguments;
     // This below is for the resolver.
     mutable const FunctionInfo* resolved = nullptr;
+    SourcePos pos = 0;
 };
 
 // Statements
 struct VarDeclStmt {
-    std::string name;
+    Symbol name;
     bool isMutable;
     Expr value;
 
     std::string annotated_type;
+    mutable SlotRef slot;
+    SourcePos pos = 0;
 };
 
 struct ExprStmt {
     Expr expression;
 };
 
-struct BreakStmt {};
+struct BreakStmt {
+    SourcePos pos = 0;
+};
 
-struct ContinueStmt {};
+struct ContinueStmt {
+    SourcePos pos = 0;
+};
 struct FunctionDecl;
 
 struct ReturnStmt {
     Expr value;
+    SourcePos pos = 0;
 };
 
 struct ImportStmt {
-    std::vector<std::string> path;
+    std::vector<Symbol> path;
     bool wild_card;
+    SourcePos pos = 0;
 };
 
 struct ModuleDecl;
+struct StructDecl;
 
 using Stmt = std::variant<
     VarDeclStmt,
     ExprStmt,
     AssignmentStmt,
+    IndexAssignStmt,
     BreakStmt,
     ContinueStmt,
     ReturnStmt,
     ImportStmt,
     std::unique_ptr<ModuleDecl>,
-    std::unique_ptr<FunctionDecl>
+    std::unique_ptr<FunctionDecl>,
+    FieldAssignStmt,
+    std::unique_ptr<StructDecl>
 >;
 
 struct BlockStmt {
@@ -110,20 +237,31 @@ struct BlockStmt {
 };
 
 struct Parameter {
-    std::string name;
+    Symbol name;
     std::string type;
 };
 
 struct FunctionDecl {
-    std::string name;
+    Symbol name;
     std::vector<Parameter> params;
     std::string returnType;
     std::unique_ptr<BlockExpr> body;
+    // Parameters take the first slots of the frame
+    mutable uint32_t frameSize = 0;
+    SourcePos pos = 0;
+};
+
+// struct Name { field: type, ... }. Struct names are program-wide, wherever they are declared
+struct StructDecl {
+    Symbol name;
+    std::vector<Parameter> fields;
+    SourcePos pos = 0;
 };
 
 struct ModuleDecl {
-    std::string name;
+    Symbol name;
     std::vector<Stmt> body;
+    SourcePos pos = 0;
 };
 
 
@@ -136,9 +274,70 @@ struct IfExpr {
     Expr condition;
     std::unique_ptr<BlockExpr> thenBranch;
     std::unique_ptr<BlockExpr> elseBranch;
+    SourcePos pos = 0;
 };
 
 struct WhileExpr {
     Expr conditional;
     std::unique_ptr<BlockExpr> body;
+    SourcePos pos = 0;
+};
+
+// How a `par for ... reduce op` combines the values its iterations produce
+enum class ReduceOp {
+    None,
+    Sum,
+    Product,
+    Min,
+    Max
+};
+
+// for name in start..end: counts from start up to (not including) end, both evaluated once.
+// for name in array: visits the elements of the array, which is evaluated once.
+// par for runs the iterations on several threads (Parallel/WorkPool.h); with `reduce op` it
+// combines the values its body ends in into the value of the loop.
+struct ForExpr {
+    Symbol name;
+    Expr start; // The array for an element loop
+    std::unique_ptr<Expr> end; // Null for an element loop
+    std::unique_ptr<BlockExpr> body;
+    bool parallel = false;
+    ReduceOp reduce = ReduceOp::None;
+    mutable SlotRef slot; // The counter or element, an immutable local to the loop
+    mutable bool reducesDoubles = false; // Set by the TypeChecker for a double reduction
+    SourcePos pos = 0;
+};
+
+// loop { }: runs until a break
+struct LoopExpr {
+    std::unique_ptr<BlockExpr> body;
+    SourcePos pos = 0;
 };
+
+// Source position of a node for diagnostics; 0 for nodes that carry none (literals, blocks)
+template<class Node>
+SourcePos positionOf(const Node& node) {
+    return std::visit([](const auto& n) -> SourcePos {
+        using T = std::decay_t<decltype(n)>;
+
+        if constexpr (requires { n->pos; }) return n->pos;
+        else if constexpr (requires { n.pos; }) return n.pos;
+        else if constexpr (std::is_same_v<T, ExprStmt>) return positionOf(n.expression);
+        else return 0;
+    }, node);
+}
+
+// Kinds of nodes for per-node reports: the Expr alternatives, then the Stmt alternatives
+inline std::vector<const char*> nodeKindNames() {
+    static_assert(std::variant_size_v<Expr> == 15 && std::variant_size_v<Stmt> == 12, "Update nodeKindNames");
+
+    return {
+        "literal", "variable", "binary", "unary", "call", "if", "block", "while", "index", "array", "for", "loop",
+        "struct literal", "field", "map literal",
+        "let", "expression statement", "assignment", "index assignment", "break", "continue", "return", "import", "mod", "fn",
+        "field assignment", "struct"
+    };
+}
+
+inline size_t nodeKind(const Expr& expr) { return expr.index(); }
+inline size_t nodeKind(const Stmt& stmt) { return std::variant_size_v<Expr> + stmt.index(); }
@@ -0,0 +1,160 @@
+// raft_bench: times each stage of the pipeline (lex, parse, declare, check, execute) and the
+// whole run on every program in the benchmark corpus, and writes the results as JSON so that
+// runs can be compared.
+//
+// Usage: raft_bench [--filter=NAME] [--min-time=SECONDS] [--output=FILE] [CORPUS_DIR]
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+#include "Bench/Harness.h"
+#include "Driver/Driver.h"
+#include "Interpreter/Interpreter.h"
+#include "Resolver/Resolver.h"
+#include "TypeChecker/TypeChecker.h"
+#include "IO/Console.h"
+
+namespace fs = std::filesystem;
+
+#ifndef RAFT_BENCH_DIR
+#define RAFT_BENCH_DIR "bench"
+#endif
+
+namespace {
+    // Swallows the programs' output while they are timed
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    std::string readFile(const fs::path& path) {
+        std::ifstream file(path);
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return buffer.str();
+    }
+
+    std::vector<BenchProgram> loadCorpus(const fs::path& dir, const std::string& filter) {
+        std::vector<BenchProgram> programs;
+
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            fs::path main = entry.path() / "main.rft";
+            if (!entry.is_directory() || !fs::is_regular_file(main)) continue;
+
+            std::string name = entry.path().filename().string();
+            if (name.find(filter) == std::string::npos) continue;
+
+            BenchProgram program{ name, main, {} };
+            for (const auto& file : fs::directory_iterator(entry.path())) {
+                if (file.path().extension() != ".rft") continue;
+
+                bool isEntry = file.path() == main;
+                program.files.push_back(SourceFile{ readFile(file.path()), isEntry, intern(file.path().stem().string()) });
+            }
+
+            programs.push_back(std::move(program));
+        }
+
+        std::sort(programs.begin(), programs.end(), [](const auto& a, const auto& b) { return a.name < b.name; });
+        return programs;
+    }
+
+    std::vector<BenchResult> benchProgram(const BenchProgram& program, const BenchSettings& settings) {
+        std::vector<BenchResult> results;
+        std::vector<std::vector<Token>> tokens;
+        std::vector<Stmt> ast;
+        std::optional<Resolver> resolver;
+        ProgramLayout layout;
+
+        auto lex = [&] { tokens = lexAll(program); };
+        auto parse = [&] { ast = parseAll(program, tokens); };
+        auto declare = [&] {
+            resolver.emplace();
+            resolver->declareProgram(ast);
+        };
+        auto check = [&] {
+            TypeChecker checker(*resolver);
+            checker.checkProgram(ast);
+            layout = checker.layout();
+        };
+        auto execute = [&] {
+            Interpreter interpreter(&*resolver);
+            interpreter.executeProgram(ast, layout);
+        };
+
+        results.push_back(measure(program.name, "lex", settings, [] {}, lex));
+
+        lex();
+        results.push_back(measure(program.name, "parse", settings, [] {}, parse));
+        results.push_back(measure(program.name, "declare", settings, parse, declare));
+        results.push_back(measure(program.name, "check", settings, [&] { parse(); declare(); }, check));
+        results.push_back(measure(program.name, "execute", settings, [&] { parse(); declare(); check(); }, execute));
+
+        // Whole run from the files on disk, as `raft main.rft` does it
+        results.push_back(measure(program.name, "total", settings, [] {}, [&] {
+            ModuleLoader loader(program.entry.string());
+            compileAndRun(loader, RunOptions{});
+        }));
+
+        return results;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchSettings settings;
+    std::string filter;
+    std::string output;
+    fs::path corpus = RAFT_BENCH_DIR;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--filter=", 0) == 0) filter = arg.substr(9);
+        else if (arg.rfind("--min-time=", 0) == 0) settings.minSeconds = std::stod(arg.substr(11));
+        else if (arg.rfind("--output=", 0) == 0) output = arg.substr(9);
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+        else corpus = arg;
+    }
+
+    if (!fs::is_directory(corpus)) {
+        std::cerr << "No benchmark corpus at " << corpus << "\n";
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    NullBuffer null;
+
+    for (const auto& program : loadCorpus(corpus, filter)) {
+        std::streambuf* previous = std::cout.rdbuf(&null);
+        Output::standard().redirect(nullptr);
+
+        try {
+            auto programResults = benchProgram(program, settings);
+            results.insert(results.end(), programResults.begin(), programResults.end());
+        } catch (const std::exception& e) {
+            std::cerr << program.name << ": " << e.what() << "\n";
+        }
+
+        Output::standard().redirect(stdout);
+        std::cout.rdbuf(previous);
+    }
+
+    printSummary(std::cerr, results);
+
+    if (output.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream file(output);
+        writeJson(file, results);
+    }
+
+    return 0;
+}
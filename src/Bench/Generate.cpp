@@ -0,0 +1,43 @@
+// raft_gen: writes a synthetic Raft project (main.rft plus sibling module files) for
+// front-end scalability testing. Run the result with `raft DIR/main.rft`.
+//
+// Usage: raft_gen --out=DIR [--files=N] [--mods=N] [--depth=N] [--fns=N] [--imports=N] [--expr=N]
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "Bench/Generator.h"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    fs::path out;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--out=", 0) == 0) out = arg.substr(6);
+        else if (!parseGeneratorOption(arg, options)) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (out.empty()) {
+        std::cerr << "Usage: raft_gen --out=DIR [--files=N] [--mods=N] [--depth=N] [--fns=N] [--imports=N] [--expr=N]\n";
+        return 1;
+    }
+
+    BenchProgram program = generateProgram(options);
+    fs::create_directories(out);
+
+    for (const auto& file : program.files) {
+        std::ofstream(out / ((file.entry ? "main" : symbolName(file.module)) + ".rft")) << file.text;
+    }
+
+    std::cerr << "Wrote " << program.files.size() << " files with " << options.totalFunctions()
+              << " functions to " << out.string() << "\n";
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <sstream>
+
+#include "Bench/Generator.h"
+
+namespace {
+    std::string fileName(size_t file) {
+        return "f" + std::to_string(file);
+    }
+
+    // Dotted path from a file's root to the innermost module of one of its mods
+    std::string modulePath(const GeneratorOptions& options, size_t module) {
+        std::string path = "m" + std::to_string(module);
+        for (size_t level = 1; level < options.depth; level++) path += ".d" + std::to_string(level);
+        return path;
+    }
+
+    std::string functionName(size_t index) {
+        return "g" + std::to_string(index);
+    }
+
+    void indent(std::ostringstream& out, size_t level) {
+        out << std::string(level * 4, ' ');
+    }
+
+    void writeFunction(std::ostringstream& out, const GeneratorOptions& options, size_t file, size_t index, size_t level) {
+        indent(out, level);
+        out << "fn " << functionName(index) << "(x: int) int {\n";
+
+        std::vector<std::string> terms;
+        if (index > 0) terms.push_back(functionName(index - 1) + "(x)");
+        terms.push_back("base(x)");
+        if (file + 1 < options.files) terms.push_back(fileName(file + 1) + ".base(x)");
+
+        for (size_t t = 0; terms.size() < options.exprSize; t++) {
+            switch (t % 3) {
+                case 0: terms.push_back("x"); break;
+                case 1: terms.push_back("(x - " + std::to_string(t) + ")"); break;
+                default: terms.push_back(std::to_string(t)); break;
+            }
+        }
+
+        indent(out, level + 1);
+        for (size_t t = 0; t < terms.size(); t++) out << (t ? " + " : "") << terms[t];
+        out << "\n";
+
+        indent(out, level);
+        out << "}\n";
+    }
+
+    std::string writeModuleFile(const GeneratorOptions& options, size_t file) {
+        std::ostringstream out;
+
+        out << "fn base(x: int) int {\n    x + " << file << "\n}\n\n";
+
+        for (size_t module = 0; module < options.modules; module++) {
+            out << "mod m" << module << " {\n";
+            for (size_t level = 1; level < options.depth; level++) {
+                indent(out, level);
+                out << "mod d" << level << " {\n";
+            }
+
+            size_t inner = options.depth;
+            for (size_t index = 0; index < options.functions; index++) {
+                if (index > 0) out << "\n";
+                writeFunction(out, options, file, index, inner);
+            }
+
+            for (size_t level = inner; level-- > 0;) {
+                indent(out, level);
+                out << "}\n";
+            }
+            out << "\n";
+        }
+
+        return out.str();
+    }
+
+    std::string writeEntryFile(const GeneratorOptions& options) {
+        std::ostringstream out;
+        out << "import std.io.*;\n";
+
+        for (size_t i = 0; i < options.imports; i++) {
+            size_t file = i % options.files;
+            size_t module = (i / options.files) % options.modules;
+
+            out << "import " << fileName(file) << "." << modulePath(options, module) << (i % 2 == 0 ? ".*" : "") << ";\n";
+        }
+
+        out << "\nfn main() {\n    let var total = 0;\n";
+
+        for (size_t file = 0; file < options.files; file++) {
+            for (size_t module = 0; module < options.modules; module++) {
+                out << "    total = total + " << fileName(file) << "." << modulePath(options, module) << "."
+                    << functionName(options.functions - 1) << "(1);\n";
+            }
+        }
+
+        out << "    println(total);\n}\n";
+        return out.str();
+    }
+}
+
+BenchProgram generateProgram(const GeneratorOptions& options) {
+    std::ostringstream name;
+    name << "files=" << options.files << ",mods=" << options.modules << ",depth=" << options.depth
+         << ",fns=" << options.functions << ",imports=" << options.imports << ",expr=" << options.exprSize;
+
+    BenchProgram program{ name.str(), {}, {} };
+
+    for (size_t file = 0; file < options.files; file++) {
+        program.files.push_back(SourceFile{ writeModuleFile(options, file), false, intern(fileName(file)) });
+    }
+    program.files.push_back(SourceFile{ writeEntryFile(options), true, intern("main") });
+
+    return program;
+}
+
+size_t* generatorParameter(GeneratorOptions& options, const std::string& name) {
+    if (name == "files") return &options.files;
+    if (name == "mods") return &options.modules;
+    if (name == "depth") return &options.depth;
+    if (name == "fns") return &options.functions;
+    if (name == "imports") return &options.imports;
+    if (name == "expr") return &options.exprSize;
+
+    return nullptr;
+}
+
+bool parseGeneratorOption(const std::string& arg, GeneratorOptions& options) {
+    size_t equals = arg.find('=');
+    if (arg.rfind("--", 0) != 0 || equals == std::string::npos) return false;
+
+    size_t* parameter = generatorParameter(options, arg.substr(2, equals - 2));
+    if (!parameter) return false;
+
+    // Every shape parameter needs at least one of its kind, except imports
+    *parameter = std::stoul(arg.substr(equals + 1));
+    if (*parameter == 0 && parameter != &options.imports) *parameter = 1;
+
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Bench/Harness.h"
+
+// Shape of a synthetic Raft project. Every sibling file declares `modules` top level mods,
+// each nested `depth` levels deep with `functions` functions in the innermost one. Every
+// function body is an expression of `exprSize` terms that calls the previous function, a
+// helper at the file's root (found by climbing out of the nested scopes) and the next
+// file's helper through its full path. The entry file has `imports` imports, half of them
+// wildcards, so that alias setup and wildcard copying are exercised.
+struct GeneratorOptions {
+    size_t files = 4;
+    size_t modules = 4;
+    size_t depth = 3;
+    size_t functions = 16;
+    size_t imports = 4;
+    size_t exprSize = 8;
+
+    size_t totalFunctions() const { return files * modules * functions; }
+};
+
+BenchProgram generateProgram(const GeneratorOptions&);
+
+// The option names the tools take: files, mods, depth, fns, imports and expr
+size_t* generatorParameter(GeneratorOptions&, const std::string& name);
+
+// Applies "--fns=64" and the like, returning false for other arguments
+bool parseGeneratorOption(const std::string& arg, GeneratorOptions&);
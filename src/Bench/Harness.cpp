@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "Bench/Harness.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+
+std::vector<std::vector<Token>> lexAll(const BenchProgram& program) {
+    std::vector<std::vector<Token>> tokens;
+
+    for (const auto& file : program.files) {
+        Lexer lexer;
+        tokens.push_back(lexer.scanTokens(file.text));
+        if (lexer.error()) throw std::runtime_error("Lexing failed in " + program.name);
+    }
+
+    return tokens;
+}
+
+std::vector<Stmt> parseAll(const BenchProgram& program, const std::vector<std::vector<Token>>& tokens) {
+    std::vector<Stmt> modules, entry;
+
+    for (size_t i = 0; i < program.files.size(); i++) {
+        const auto& file = program.files[i];
+        Parser parser(tokens[i], openSourceFile(file.entry ? "main.rft" : symbolName(file.module) + ".rft"));
+        auto statements = parser.parse();
+
+        if (file.entry) {
+            for (auto& stmt : statements) entry.push_back(std::move(stmt));
+        } else {
+            modules.push_back(std::make_unique<ModuleDecl>(ModuleDecl{ file.module, std::move(statements) }));
+        }
+    }
+
+    for (auto& stmt : entry) modules.push_back(std::move(stmt));
+    return modules;
+}
+
+BenchResult measure(const std::string& program, const std::string& stage, const BenchSettings& settings,
+                    const std::function<void()>& setup, const std::function<void()>& body) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    double total = 0;
+
+    setup();
+    body(); // Warm up caches and the allocator
+
+    auto began = Clock::now();
+    auto budget = std::chrono::duration<double>(settings.minSeconds);
+
+    while (samples.size() < settings.maxIterations &&
+           (samples.size() < settings.minIterations || Clock::now() - began < budget)) {
+        setup();
+
+        auto start = Clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        samples.push_back(ns);
+        total += ns;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return BenchResult{ program, stage, samples.size(), samples.front(), samples[samples.size() / 2], total / samples.size() };
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n  \"benchmarks\": [\n" << std::fixed << std::setprecision(1);
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        out << "    {\"program\": \"" << r.program << "\", \"stage\": \"" << r.stage << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"min_ns\": " << r.minNs
+            << ", \"median_ns\": " << r.medianNs
+            << ", \"mean_ns\": " << r.meanNs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n}\n";
+}
+
+void printSummary(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << std::left << std::setw(12) << "program" << std::setw(10) << "stage" << std::right
+        << std::setw(12) << "iterations" << std::setw(14) << "median us" << std::setw(14) << "min us" << "\n";
+
+    for (const auto& r : results) {
+        out << std::left << std::setw(12) << r.program << std::setw(10) << r.stage << std::right
+            << std::setw(12) << r.iterations << std::fixed << std::setprecision(2)
+            << std::setw(14) << r.medianNs / 1e3 << std::setw(14) << r.minNs / 1e3 << "\n";
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AST/AST.h"
+#include "Util/token.h"
+
+// Shared by the benchmark tools: a program held in memory, the stage runners and the timing loop
+
+struct SourceFile {
+    std::string text;
+    bool entry;
+    Symbol module; // Sibling files are modules named after the file
+};
+
+struct BenchProgram {
+    std::string name;
+    std::filesystem::path entry; // Empty for generated programs that only exist in memory
+    std::vector<SourceFile> files;
+};
+
+struct BenchSettings {
+    double minSeconds = 0.3;
+    size_t minIterations = 5;
+    size_t maxIterations = 100000;
+};
+
+struct BenchResult {
+    std::string program;
+    std::string stage;
+    size_t iterations;
+    double minNs;
+    double medianNs;
+    double meanNs;
+};
+
+std::vector<std::vector<Token>> lexAll(const BenchProgram&);
+
+// Same layout the driver builds: sibling modules first, then the entry file
+std::vector<Stmt> parseAll(const BenchProgram&, const std::vector<std::vector<Token>>&);
+
+// Runs setup (untimed) and body (timed) until both minimums are met. The time budget
+// counts setup too, so that stages with an expensive setup don't run for long
+BenchResult measure(const std::string& program, const std::string& stage, const BenchSettings&,
+                    const std::function<void()>& setup, const std::function<void()>& body);
+
+void writeJson(std::ostream&, const std::vector<BenchResult>&);
+void printSummary(std::ostream&, const std::vector<BenchResult>&);
@@ -0,0 +1,121 @@
+// raft_kernels: times every std.math array kernel at every SIMD level the CPU supports and
+// prints the time per element and the speedup over the scalar kernels. The results are written
+// as JSON like raft_bench's, with the level as the program and kernel/size as the stage.
+//
+// Usage: raft_kernels [--filter=NAME] [--size=ELEMENTS] [--min-time=SECONDS] [--output=FILE]
+
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "Bench/Harness.h"
+#include "Kernels/Kernels.h"
+
+namespace {
+    struct KernelCase {
+        std::string name;
+        std::function<void(const Kernels&)> run;
+    };
+
+    // Keeps results alive so that the kernels can't be optimized away
+    volatile double sinkDouble;
+    volatile int64_t sinkInt;
+
+    std::vector<KernelCase> kernelCases(size_t n) {
+        static std::vector<double> a, b, out;
+        static std::vector<int64_t> ia, ib, iout;
+
+        a.resize(n); b.resize(n); out.resize(n);
+        ia.resize(n); ib.resize(n); iout.resize(n);
+
+        for (size_t i = 0; i < n; i++) {
+            a[i] = 1.0 + i % 97;
+            b[i] = 0.5 * (i % 13);
+            ia[i] = static_cast<int64_t>(i % 1000) - 500;
+            ib[i] = static_cast<int64_t>(i % 7);
+        }
+
+        return {
+            { "f64.sum", [n](const Kernels& k) { sinkDouble = k.f64.sum(a.data(), n); } },
+            { "f64.dot", [n](const Kernels& k) { sinkDouble = k.f64.dot(a.data(), b.data(), n); } },
+            { "f64.min", [n](const Kernels& k) { sinkDouble = k.f64.min(a.data(), n); } },
+            { "f64.max", [n](const Kernels& k) { sinkDouble = k.f64.max(a.data(), n); } },
+            { "f64.add", [n](const Kernels& k) { k.f64.add(a.data(), b.data(), out.data(), n); } },
+            { "f64.mul", [n](const Kernels& k) { k.f64.mul(a.data(), b.data(), out.data(), n); } },
+            { "f64.scale", [n](const Kernels& k) { k.f64.scale(a.data(), 1.5, out.data(), n); } },
+            { "f64.sqrt", [n](const Kernels& k) { k.sqrt(a.data(), out.data(), n); } },
+            { "f64.pow", [n](const Kernels& k) { k.pow(a.data(), 1.5, out.data(), n); } },
+            { "i64.sum", [n](const Kernels& k) { sinkInt = k.i64.sum(ia.data(), n); } },
+            { "i64.dot", [n](const Kernels& k) { sinkInt = k.i64.dot(ia.data(), ib.data(), n); } },
+            { "i64.min", [n](const Kernels& k) { sinkInt = k.i64.min(ia.data(), n); } },
+            { "i64.max", [n](const Kernels& k) { sinkInt = k.i64.max(ia.data(), n); } },
+            { "i64.add", [n](const Kernels& k) { k.i64.add(ia.data(), ib.data(), iout.data(), n); } },
+            { "i64.mul", [n](const Kernels& k) { k.i64.mul(ia.data(), ib.data(), iout.data(), n); } },
+            { "i64.scale", [n](const Kernels& k) { k.i64.scale(ia.data(), 3, iout.data(), n); } },
+        };
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchSettings settings;
+    settings.minSeconds = 0.1;
+    std::string filter;
+    std::string output;
+    std::vector<size_t> sizes = { 1024, 65536, 1048576 };
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--filter=", 0) == 0) filter = arg.substr(9);
+        else if (arg.rfind("--size=", 0) == 0) sizes = { std::stoul(arg.substr(7)) };
+        else if (arg.rfind("--min-time=", 0) == 0) settings.minSeconds = std::stod(arg.substr(11));
+        else if (arg.rfind("--output=", 0) == 0) output = arg.substr(9);
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    SimdLevel best = detectSimdLevel();
+    std::vector<BenchResult> results;
+    std::map<std::string, double> scalarNs; // By stage, for the speedups
+
+    std::cerr << "Detected " << simdLevelName(best) << "\n"
+              << std::left << std::setw(8) << "level" << std::setw(12) << "kernel" << std::right
+              << std::setw(10) << "elements" << std::setw(12) << "ns/elem" << std::setw(14) << "Melem/s" << std::setw(10) << "speedup" << "\n";
+
+    for (size_t n : sizes) {
+        for (auto& kernel : kernelCases(n)) {
+            if (kernel.name.find(filter) == std::string::npos) continue;
+
+            for (int level = 0; level <= static_cast<int>(best); level++) {
+                const Kernels& k = kernelsFor(static_cast<SimdLevel>(level));
+                if (k.level != static_cast<SimdLevel>(level)) continue; // Not in this build
+
+                std::string stage = kernel.name + "/" + std::to_string(n);
+                BenchResult result = measure(simdLevelName(k.level), stage, settings, [] {}, [&] { kernel.run(k); });
+                results.push_back(result);
+
+                if (k.level == SimdLevel::Scalar) scalarNs[stage] = result.medianNs;
+                double perElement = result.medianNs / n;
+
+                std::cerr << std::left << std::setw(8) << simdLevelName(k.level) << std::setw(12) << kernel.name << std::right
+                          << std::setw(10) << n << std::fixed << std::setprecision(3) << std::setw(12) << perElement
+                          << std::setprecision(1) << std::setw(14) << 1e3 / perElement
+                          << std::setprecision(2) << std::setw(9) << scalarNs[stage] / result.medianNs << "x\n";
+            }
+        }
+    }
+
+    if (output.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream file(output);
+        writeJson(file, results);
+    }
+
+    return 0;
+}
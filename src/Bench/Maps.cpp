@@ -0,0 +1,158 @@
+// raft_maps: times the Swiss table behind std.collections maps against std::unordered_map, for int
+// and string keys, and prints the time per operation and the speedup over std::unordered_map. The
+// results are written as JSON like raft_bench's, with the container as the program and
+// keys.operation/size as the stage.
+//
+// Usage: raft_maps [--filter=NAME] [--size=KEYS] [--min-time=SECONDS] [--output=FILE]
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Bench/Harness.h"
+#include "Collections/SwissTable.h"
+
+namespace {
+    // Keeps results alive so that the lookups can't be optimized away
+    volatile int64_t sink;
+
+    template<class K> void put(SwissTable<K, int64_t>& table, const K& key, int64_t value) { table.insert(key).first = value; }
+    template<class K> void put(std::unordered_map<K, int64_t>& table, const K& key, int64_t value) { table[key] = value; }
+
+    template<class K> int64_t lookup(const SwissTable<K, int64_t>& table, const K& key) {
+        const int64_t* value = table.find(key);
+        return value ? *value : 0;
+    }
+
+    template<class K> int64_t lookup(const std::unordered_map<K, int64_t>& table, const K& key) {
+        auto it = table.find(key);
+        return it == table.end() ? 0 : it->second;
+    }
+
+    struct MapCase {
+        std::string name;
+        std::function<void()> setup;
+        std::function<void()> run;
+    };
+
+    // The same operations for either container. present are the keys that get inserted, absent
+    // ones that never are, and shuffled the present ones in another order. Lookups go in that
+    // order, since looking keys up in the order they were inserted favours node-based containers,
+    // whose nodes are then visited in the order they were allocated. The cases run after this
+    // returns, so fill is captured by value; what it refers to is the caller's.
+    template<class Table, class K>
+    std::vector<MapCase> mapCases(Table& table, const std::vector<K>& present, const std::vector<K>& absent, const std::vector<K>& shuffled) {
+        auto fill = [&] {
+            table.clear();
+            for (size_t i = 0; i < present.size(); i++) put(table, present[i], static_cast<int64_t>(i));
+        };
+
+        return {
+            { "insert", [&] { table = Table(); }, [&] {
+                for (size_t i = 0; i < present.size(); i++) put(table, present[i], static_cast<int64_t>(i));
+            } },
+            { "reserved", [&] { table = Table(); table.reserve(present.size()); }, [&] {
+                for (size_t i = 0; i < present.size(); i++) put(table, present[i], static_cast<int64_t>(i));
+            } },
+            { "hit", [fill, &table, &present] { if (table.size() != present.size()) fill(); }, [&] {
+                int64_t total = 0;
+                for (const auto& key : shuffled) total += lookup(table, key);
+                sink = total;
+            } },
+            { "miss", [fill, &table, &present] { if (table.size() != present.size()) fill(); }, [&] {
+                int64_t total = 0;
+                for (const auto& key : absent) total += lookup(table, key);
+                sink = total;
+            } },
+            { "erase", fill, [&] { for (const auto& key : shuffled) table.erase(key); } },
+        };
+    }
+
+    struct Runner {
+        BenchSettings settings;
+        std::string filter;
+        std::vector<BenchResult> results;
+        std::map<std::string, double> baselineNs; // std::unordered_map's, by stage
+
+        template<class Table, class K>
+        void run(const std::string& container, const std::string& keyType, const std::vector<K>& present, const std::vector<K>& absent) {
+            Table table;
+            std::vector<K> shuffled = present;
+            std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(42));
+
+            for (auto& c : mapCases(table, present, absent, shuffled)) {
+                std::string name = keyType + "." + c.name;
+                if (name.find(filter) == std::string::npos) continue;
+
+                std::string stage = name + "/" + std::to_string(present.size());
+                BenchResult result = measure(container, stage, settings, c.setup, c.run);
+                results.push_back(result);
+
+                if (!baselineNs.count(stage)) baselineNs[stage] = result.medianNs;
+                double perOp = result.medianNs / present.size();
+
+                std::cerr << std::left << std::setw(15) << container << std::setw(16) << name << std::right
+                          << std::setw(10) << present.size() << std::fixed << std::setprecision(2) << std::setw(10) << perOp
+                          << std::setprecision(1) << std::setw(10) << 1e3 / perOp
+                          << std::setprecision(2) << std::setw(9) << baselineNs[stage] / result.medianNs << "x\n";
+            }
+        }
+    };
+}
+
+int main(int argc, char* argv[]) {
+    Runner runner;
+    runner.settings.minSeconds = 0.1;
+    std::string output;
+    std::vector<size_t> sizes = { 1024, 65536, 1048576 };
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--filter=", 0) == 0) runner.filter = arg.substr(9);
+        else if (arg.rfind("--size=", 0) == 0) sizes = { std::stoul(arg.substr(7)) };
+        else if (arg.rfind("--min-time=", 0) == 0) runner.settings.minSeconds = std::stod(arg.substr(11));
+        else if (arg.rfind("--output=", 0) == 0) output = arg.substr(9);
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::cerr << std::left << std::setw(15) << "container" << std::setw(16) << "operation" << std::right
+              << std::setw(10) << "keys" << std::setw(10) << "ns/op" << std::setw(10) << "Mops/s" << std::setw(10) << "speedup" << "\n";
+
+    for (size_t n : sizes) {
+        // Scattered ints, and strings shaped like identifiers; odd multipliers keep them distinct
+        std::vector<int64_t> ints(n), missingInts(n);
+        std::vector<std::string> strings(n), missingStrings(n);
+
+        for (size_t i = 0; i < n; i++) {
+            ints[i] = static_cast<int64_t>(i * 2654435761u);
+            missingInts[i] = -1 - static_cast<int64_t>(i * 40503u);
+            strings[i] = "key_" + std::to_string(i * 7919);
+            missingStrings[i] = "absent_" + std::to_string(i * 7919);
+        }
+
+        runner.run<std::unordered_map<int64_t, int64_t>>("unordered_map", "int", ints, missingInts);
+        runner.run<SwissTable<int64_t, int64_t>>("swiss", "int", ints, missingInts);
+        runner.run<std::unordered_map<std::string, int64_t>>("unordered_map", "string", strings, missingStrings);
+        runner.run<SwissTable<std::string, int64_t>>("swiss", "string", strings, missingStrings);
+    }
+
+    if (output.empty()) {
+        writeJson(std::cout, runner.results);
+    } else {
+        std::ofstream file(output);
+        writeJson(file, runner.results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// raft_scale: generates synthetic projects of growing size and times each front-end phase
+// (lex, parse, declare, check) on them. One shape parameter is doubled per step; a phase
+// whose time grows faster than its input is flagged as nonlinear.
+//
+// Usage: raft_scale [--vary=fns|files|mods|depth|imports|expr] [--steps=N] [--min-time=SECONDS]
+//                   [--output=FILE] [--files=N] [--mods=N] [--depth=N] [--fns=N] [--imports=N] [--expr=N]
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+
+#include "Bench/Generator.h"
+#include "Resolver/Resolver.h"
+#include "TypeChecker/TypeChecker.h"
+
+namespace {
+    const char* const Stages[] = { "lex", "parse", "declare", "check" };
+    constexpr size_t StageCount = 4;
+
+    // Doubling the input should at most double the time; allow some noise
+    constexpr double NonlinearExponent = 1.25;
+
+    std::vector<BenchResult> measureFrontEnd(const BenchProgram& program, const BenchSettings& settings) {
+        std::vector<std::vector<Token>> tokens;
+        std::vector<Stmt> ast;
+        std::optional<Resolver> resolver;
+
+        auto lex = [&] { tokens = lexAll(program); };
+        auto parse = [&] { ast = parseAll(program, tokens); };
+        auto declare = [&] {
+            resolver.emplace();
+            resolver->declareProgram(ast);
+        };
+        auto check = [&] {
+            TypeChecker checker(*resolver);
+            checker.checkProgram(ast);
+        };
+
+        std::vector<BenchResult> results;
+        results.push_back(measure(program.name, "lex", settings, [] {}, lex));
+
+        lex();
+        results.push_back(measure(program.name, "parse", settings, [] {}, parse));
+        results.push_back(measure(program.name, "declare", settings, parse, declare));
+        results.push_back(measure(program.name, "check", settings, [&] { parse(); declare(); }, check));
+
+        return results;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    BenchSettings settings;
+    settings.minSeconds = 0.2;
+    settings.minIterations = 3;
+
+    std::string vary = "fns";
+    size_t steps = 6;
+    std::string output;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg.rfind("--vary=", 0) == 0) vary = arg.substr(7);
+        else if (arg.rfind("--steps=", 0) == 0) steps = std::stoul(arg.substr(8));
+        else if (arg.rfind("--min-time=", 0) == 0) settings.minSeconds = std::stod(arg.substr(11));
+        else if (arg.rfind("--output=", 0) == 0) output = arg.substr(9);
+        else if (!parseGeneratorOption(arg, options)) {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    size_t* varied = generatorParameter(options, vary);
+    if (!varied) {
+        std::cerr << "Cannot vary " << vary << ", choose one of files, mods, depth, fns, imports or expr\n";
+        return 1;
+    }
+    if (*varied == 0) *varied = 1;
+
+    std::vector<BenchResult> results;
+    double previous[StageCount] = {};
+
+    std::cerr << std::left << std::setw(10) << vary << std::setw(12) << "functions" << std::right;
+    for (const char* stage : Stages) std::cerr << std::setw(14) << (std::string(stage) + " ms") << std::setw(8) << "exp";
+    std::cerr << "\n";
+
+    for (size_t step = 0; step < steps; step++, *varied *= 2) {
+        BenchProgram program = generateProgram(options);
+
+        std::vector<BenchResult> stepResults;
+        try {
+            stepResults = measureFrontEnd(program, settings);
+        } catch (const std::exception& e) {
+            std::cerr << program.name << ": " << e.what() << "\n";
+            return 1;
+        }
+
+        std::cerr << std::left << std::setw(10) << *varied << std::setw(12) << options.totalFunctions() << std::right;
+
+        // The exponent is log2 of how much the phase slowed down when its input doubled
+        for (size_t i = 0; i < StageCount; i++) {
+            double ms = stepResults[i].medianNs / 1e6;
+            std::cerr << std::fixed << std::setprecision(3) << std::setw(14) << ms;
+
+            if (step == 0 || previous[i] <= 0) {
+                std::cerr << std::setw(8) << "-";
+            } else {
+                double exponent = std::log2(ms / previous[i]);
+                std::cerr << std::setprecision(2) << std::setw(7) << exponent << (exponent > NonlinearExponent ? "!" : " ");
+            }
+
+            previous[i] = ms;
+        }
+        std::cerr << "\n";
+
+        results.insert(results.end(), stepResults.begin(), stepResults.end());
+    }
+
+    if (output.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream file(output);
+        writeJson(file, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAFT_SWISS_SSE2 1
+#endif
+
+// Hashes for the keys Raft maps have. The low 7 bits go into the control bytes and the bits above
+// pick the group, so all of them have to be well spread.
+inline uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+template<class Key> struct SwissHash;
+
+// Ints take one wide multiply, folded so that every bit of the key reaches the low bits too
+template<> struct SwissHash<int64_t> {
+    uint64_t operator()(int64_t key) const {
+#ifdef __SIZEOF_INT128__
+        unsigned __int128 product = static_cast<unsigned __int128>(static_cast<uint64_t>(key)) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+        return mixHash(static_cast<uint64_t>(key));
+#endif
+    }
+};
+
+template<> struct SwissHash<std::string> {
+    uint64_t operator()(const std::string& key) const { return mixHash(std::hash<std::string_view>{}(key)); }
+};
+
+// An open-addressing hash table in the style of Abseil's Swiss tables. Slots are split into groups
+// of 16, and each slot has a control byte: empty, deleted, or the low 7 bits of its key's hash.
+// A lookup compares all 16 control bytes of a group with one SSE2 instruction and only looks at
+// the keys whose bytes matched, so most misses never touch a key at all. The table keeps at least
+// an eighth of its slots empty, and a lookup stops at the first group with an empty slot.
+template<class Key, class Value, class Hash = SwissHash<Key>>
+class SwissTable {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return slotCount; }
+
+    Value* find(const Key& key) {
+        size_t index = indexOf(key);
+        return index == npos ? nullptr : &slots[index].value;
+    }
+
+    const Value* find(const Key& key) const {
+        size_t index = indexOf(key);
+        return index == npos ? nullptr : &slots[index].value;
+    }
+
+    bool contains(const Key& key) const { return indexOf(key) != npos; }
+
+    // The value for key, inserted as Value{} if there was none; the bool says whether it was
+    std::pair<Value&, bool> insert(const Key& key) {
+        uint64_t hash = Hash{}(key);
+        size_t index = probe(key, hash);
+        if (index != npos) return { slots[index].value, false };
+
+        size_t free = slotCount ? firstFree(hash) : 0;
+        if (slotCount == 0 || (growthLeft == 0 && control[free] == Empty)) {
+            rehashForInsert();
+            free = firstFree(hash);
+        }
+
+        if (control[free] == Empty) growthLeft--;
+        else tombstones--;
+
+        control[free] = h2(hash);
+        slots[free].key = key;
+        count++;
+
+        return { slots[free].value, true };
+    }
+
+    bool erase(const Key& key) {
+        size_t index = indexOf(key);
+        if (index == npos) return false;
+
+        // A lookup only probes past a group that has no empty slot. If this group already has one,
+        // no probe runs through it, so the slot can go back to empty rather than to a tombstone.
+        if (Group(control.get() + index / GroupWidth * GroupWidth).matchEmpty()) {
+            control[index] = Empty;
+            growthLeft++;
+        } else {
+            control[index] = Deleted;
+            tombstones++;
+        }
+
+        slots[index] = Slot{};
+        count--;
+        return true;
+    }
+
+    // Makes room for at least n keys, so that inserting them does not rehash
+    void reserve(size_t n) {
+        size_t wanted = capacityFor(n);
+        if (wanted > slotCount) resize(wanted);
+    }
+
+    void clear() {
+        control.reset();
+        slots.reset();
+        slotCount = count = tombstones = growthLeft = 0;
+    }
+
+    // Calls f(key, value) for every entry, in slot order
+    template<class F> void forEach(F&& f) const {
+        for (size_t group = 0; group < slotCount; group += GroupWidth) {
+            for (uint32_t full = Group(control.get() + group).matchFull(); full; full &= full - 1) {
+                const Slot& slot = slots[group + std::countr_zero(full)];
+                f(slot.key, slot.value);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t GroupWidth = 16;
+    static constexpr size_t npos = ~size_t{ 0 };
+
+    // Control bytes: full slots hold 0..127, the other two have the high bit set
+    static constexpr int8_t Empty = -128;
+    static constexpr int8_t Deleted = -2;
+
+    struct Slot {
+        Key key{};
+        Value value{};
+    };
+
+    // The 16 control bytes of a group, as bit masks with one bit per slot
+    struct Group {
+#ifdef RAFT_SWISS_SSE2
+        __m128i bytes;
+
+        explicit Group(const int8_t* at) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(at))) {}
+
+        uint32_t match(int8_t h) const { return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h), bytes)); }
+        uint32_t matchEmpty() const { return match(Empty); }
+        uint32_t matchFull() const { return ~_mm_movemask_epi8(bytes) & 0xFFFF; }
+        uint32_t matchFree() const { return _mm_movemask_epi8(bytes); }
+#else
+        int8_t bytes[GroupWidth];
+
+        explicit Group(const int8_t* at) { std::memcpy(bytes, at, GroupWidth); }
+
+        template<class Test> uint32_t mask(Test test) const {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < GroupWidth; i++) bits |= uint32_t(test(bytes[i])) << i;
+            return bits;
+        }
+
+        uint32_t match(int8_t h) const { return mask([h](int8_t b) { return b == h; }); }
+        uint32_t matchEmpty() const { return match(Empty); }
+        uint32_t matchFull() const { return mask([](int8_t b) { return b >= 0; }); }
+        uint32_t matchFree() const { return mask([](int8_t b) { return b < 0; }); }
+#endif
+    };
+
+    std::unique_ptr<int8_t[]> control;
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount = 0;  // A power of two, and a multiple of GroupWidth, or 0
+    size_t count = 0;
+    size_t tombstones = 0;
+    size_t growthLeft = 0; // Empty slots that may still be filled before the table is over 7/8 full
+
+    static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+
+    static size_t capacityFor(size_t n) {
+        if (n == 0) return 0;
+
+        size_t capacity = GroupWidth;
+        while (capacity - capacity / 8 < n) capacity *= 2;
+        return capacity;
+    }
+
+    // Groups are visited in triangular steps (+1, +2, +3...), which reach every group of a
+    // power-of-two table
+    size_t probe(const Key& key, uint64_t hash) const {
+        if (slotCount == 0) return npos;
+
+        size_t mask = slotCount / GroupWidth - 1;
+        size_t group = (hash >> 7) & mask;
+
+        for (size_t step = 1;; step++) {
+            Group g(control.get() + group * GroupWidth);
+
+            for (uint32_t bits = g.match(h2(hash)); bits; bits &= bits - 1) {
+                size_t index = group * GroupWidth + std::countr_zero(bits);
+                if (slots[index].key == key) return index;
+            }
+
+            if (g.matchEmpty()) return npos;
+            group = (group + step) & mask;
+        }
+    }
+
+    size_t indexOf(const Key& key) const { return probe(key, Hash{}(key)); }
+
+    // The first empty or deleted slot on the key's probe sequence
+    size_t firstFree(uint64_t hash) const {
+        size_t mask = slotCount / GroupWidth - 1;
+        size_t group = (hash >> 7) & mask;
+
+        for (size_t step = 1;; step++) {
+            uint32_t free = Group(control.get() + group * GroupWidth).matchFree();
+            if (free) return group * GroupWidth + std::countr_zero(free);
+
+            group = (group + step) & mask;
+        }
+    }
+
+    // Out of empty slots: a table mostly filled with tombstones is rebuilt at the same size,
+    // anything else doubles
+    void rehashForInsert() {
+        if (slotCount == 0) resize(GroupWidth);
+        else if (count + 1 <= slotCount * 25 / 32) resize(slotCount);
+        else resize(slotCount * 2);
+    }
+
+    void resize(size_t capacity) {
+        auto oldControl = std::move(control);
+        auto oldSlots = std::move(slots);
+        size_t oldCount = slotCount;
+
+        control = std::make_unique<int8_t[]>(capacity);
+        std::memset(control.get(), Empty, capacity);
+        slots = std::make_unique<Slot[]>(capacity);
+        slotCount = capacity;
+        tombstones = 0;
+        growthLeft = capacity - capacity / 8 - count;
+
+        for (size_t i = 0; i < oldCount; i++) {
+            if (oldControl[i] < 0) continue;
+
+            uint64_t hash = Hash{}(oldSlots[i].key);
+            size_t free = firstFree(hash);
+            control[free] = h2(hash);
+            slots[free] = std::move(oldSlots[i]);
+        }
+    }
+};
@@ -0,0 +1,144 @@
+#include <iostream>
+
+#include "Driver/Driver.h"
+#include "Interpreter/Interpreter.h"
+#include "TypeChecker/TypeChecker.h"
+#include "Resolver/Resolver.h"
+#include "Profiler/Profiler.h"
+#include "Profiler/Stats.h"
+#include "Profiler/Phases.h"
+#include "Profiler/Trace.h"
+#include "Profiler/Allocations.h"
+#include "IO/Console.h"
+
+void compileAndRun(ModuleLoader& loader, const RunOptions& options) {
+    loader.beginRun();
+
+    phaseLog.enabled = options.timePhases || options.hardwareCounters;
+    phaseLog.clear();
+
+#ifdef RAFT_ALLOC_PROFILE
+    allocationProfile::enabled = options.allocationProfile;
+    allocationProfile::clear();
+#else
+    if (options.allocationProfile) std::cerr << "Allocation profiling needs a build with -DRAFT_ALLOC_PROFILE=ON\n";
+#endif
+
+    if (options.hardwareCounters && !hardwareCounters.open())
+        std::cerr << "Hardware counters are not available (needs Linux and perf_event_paranoid <= 2)\n";
+
+    if (!options.traceOutput.empty() && !tracer.open(options.traceOutput, options.traceCalls))
+        std::cerr << "Could not open trace file: " << options.traceOutput << "\n";
+
+    // Phase timings and the trace are finished however the run ends
+    struct FinishReports {
+        const RunOptions& options;
+
+        ~FinishReports() {
+            if (options.timePhases) phaseLog.print(std::cerr);
+            if (hardwareCounters.isOpen()) printHardwareCounters(std::cerr, phaseLog.records);
+
+#ifdef RAFT_ALLOC_PROFILE
+            if (allocationProfile::enabled) allocationProfile::print(std::cerr, nodeKindNames());
+            allocationProfile::enabled = false;
+#endif
+
+            hardwareCounters.close();
+            tracer.close();
+        }
+    } finishReports{ options };
+
+    auto entryProgram = loader.loadEntry();
+
+    // Discover and parse sibling files as modules, either all up front or as the Resolver asks for them
+    std::vector<Stmt> moduleStmts;
+    if (!options.lazyModules) {
+        PhaseScope phase("load modules");
+        moduleStmts = loader.loadAll();
+    }
+
+    size_t moduleCount = moduleStmts.size();
+    size_t entryCount = entryProgram.size();
+
+    std::vector<Stmt> program;
+    program.reserve(moduleStmts.size() + entryProgram.size());
+    for (auto& m : moduleStmts) program.push_back(std::move(m));
+    for (auto& s : entryProgram) program.push_back(std::move(s));
+
+    // Program layout is [sibling modules][entry file][modules loaded on demand]
+    auto giveBack = [&] {
+        std::vector<Stmt> entry, modules;
+        for (size_t i = 0; i < program.size(); i++) {
+            bool isEntry = i >= moduleCount && i < moduleCount + entryCount;
+            (isEntry ? entry : modules).push_back(std::move(program[i]));
+        }
+        loader.keep(std::move(entry), std::move(modules));
+    };
+
+    try {
+        Resolver resolver;
+        if (options.lazyModules) resolver.setModuleLoader(&loader);
+
+        {
+            PhaseScope phase("declare");
+            resolver.declareProgram(program);
+        }
+
+        // Resolves calls, types and variable slots in one walk
+        TypeChecker checker(resolver);
+
+        {
+            PhaseScope phase("check");
+            checker.checkProgram(program);
+        }
+
+        Interpreter interpreter(&resolver);
+        Profiler profiler;
+        runtimeStats = {};
+
+        if (tracer.calls) tracer.setFrameNames(resolver.functionNames());
+
+        if (options.profile && !profiler.start()) std::cerr << "Profiling is not supported on this platform\n";
+
+        // A runtime error still produces reports of what ran up to it. What the program printed
+        // comes out first, so that it precedes the reports and the error message
+        auto report = [&] {
+            Output::standard().flush();
+
+            if (options.profile) {
+                profiler.stop();
+                profiler.report(std::cerr, resolver.functionNames(), options.profileOutput);
+            }
+
+            if (options.stats != RunOptions::Stats::Off) {
+                printStats(std::cerr, runtimeStats, options.stats == RunOptions::Stats::Json);
+            }
+        };
+
+        try {
+            PhaseScope phase("execute");
+            interpreter.executeProgram(program, checker.layout());
+        } catch (...) {
+            report();
+            throw;
+        }
+
+        report();
+    } catch (...) {
+        giveBack();
+        throw;
+    }
+
+    giveBack();
+}
+
+void runFile(const std::string& entryFilePath, const RunOptions& options) {
+    ModuleLoader loader(entryFilePath);
+
+    try {
+        compileAndRun(loader, options);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+    }
+}
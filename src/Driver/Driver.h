@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include "Resolver/ModuleLoader.h"
+
+struct RunOptions {
+    bool lazyModules = false; // Only load sibling files that the program actually names
+
+    bool profile = false; // Sample the running program and print where it spent its time
+    std::string profileOutput = "raft.folded"; // Collapsed stacks for flamegraph tools
+    bool hardwareCounters = false; // Count cycles, instructions and cache misses per phase (--profile=hw)
+
+    enum class Stats { Off, Text, Json };
+    Stats stats = Stats::Off; // Print runtime counters at exit
+
+    bool timePhases = false; // Print time, allocations and peak heap of each compilation phase and file
+    bool allocationProfile = false; // Rank allocations by phase and AST node kind (builds with RAFT_ALLOC_PROFILE)
+
+    std::string traceOutput; // Chrome trace-event JSON of the compilation phases, none if empty
+    bool traceCalls = false; // Also trace every function call
+};
+
+// Lexes, parses, checks and runs the program rooted at the loader's entry file.
+// Parsed files are handed back to the loader afterwards so a resident compiler can reuse them.
+void compileAndRun(ModuleLoader& loader, const RunOptions& options);
+
+void runFile(const std::string& entryFilePath, const RunOptions& options);
+
+// Keeps the compiler resident and re-runs the program whenever a .rft file next to it changes
+int watchFile(const std::string& entryFilePath, const RunOptions& options);
+
+// Interactive session. With a root file its program is loaded first (without running main)
+int runRepl(const std::string& rootFile, const RunOptions& options);
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <chrono>
+
+#include "Driver/Driver.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "Interpreter/Interpreter.h"
+#include "TypeChecker/TypeChecker.h"
+#include "Resolver/Resolver.h"
+#include "IO/Console.h"
+
+namespace fs = std::filesystem;
+
+// One compiler and one interpreter live for the whole session. Every input is checked
+// against the module tree, types and globals built by the inputs before it, so only the
+// new code is compiled.
+class ReplSession {
+public:
+    ReplSession(const std::string& rootFile, const RunOptions& options)
+    : loader(rootFile.empty() ? (fs::current_path() / "<repl>").string() : rootFile), checker(resolver), interpreter(&resolver) {
+        // Without a root file, modules in the working directory are loaded when first named
+        if (rootFile.empty() || options.lazyModules) resolver.setModuleLoader(&loader);
+        if (rootFile.empty()) return;
+
+        // The root program is loaded but main is not run, its functions are there to be called
+        program = loader.loadAll();
+        if (options.lazyModules) program.clear();
+        for (auto& stmt : loader.loadEntry()) program.push_back(std::move(stmt));
+
+        resolver.declare(program);
+        checker.checkProgram(program);
+        interpreter.defineGlobals(program, checker.layout());
+    }
+
+    void evaluate(const std::string& source, bool timed) {
+        Lexer lexer;
+        auto tokens = lexer.scanTokens(source);
+        if (lexer.error() || tokens.front().type == TokenType::EOFILE) return;
+
+        size_t checkpoint = checker.checkpoint();
+        resolver.beginTransaction();
+
+        try {
+            auto start = std::chrono::steady_clock::now();
+
+            if (isDeclaration(tokens.front().type)) declare(tokens);
+            else run(tokens);
+
+            Output::standard().flush();
+
+            if (timed) {
+                auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+                std::cout << "(" << elapsed.count() << " ms)\n";
+            }
+
+            resolver.commit();
+        } catch (const std::exception& e) {
+            resolver.rollback();
+            checker.rollback(checkpoint);
+            interpreter.reset();
+
+            Output::standard().flush();
+            std::cerr << e.what() << '\n';
+        }
+    }
+
+private:
+    ModuleLoader loader;
+    Resolver resolver;
+    TypeChecker checker;
+    Interpreter interpreter;
+
+    // Everything accepted so far. Call sites resolved in later inputs point into these trees.
+    std::vector<Stmt> program;
+
+    // Inputs share one source map file whose positions are kept for the whole session
+    uint32_t sourceFile = openSourceFile("<repl>");
+
+    static bool isDeclaration(TokenType type) {
+        return type == TokenType::FN || type == TokenType::MOD || type == TokenType::IMPORT || type == TokenType::LET || type == TokenType::STRUCT;
+    }
+
+    // fn, mod, import, struct and let are top level declarations; lets become globals
+    void declare(const std::vector<Token>& tokens) {
+        Parser parser(tokens, sourceFile);
+        auto statements = parser.parse();
+
+        resolver.declare(statements);
+        checker.checkProgram(statements);
+        interpreter.defineGlobals(statements, checker.layout());
+
+        for (auto& stmt : statements) program.push_back(std::move(stmt));
+    }
+
+    // Anything else runs like the inside of a block; a tail expression is printed
+    void run(const std::vector<Token>& tokens) {
+        Parser parser(tokens, sourceFile);
+        auto block = parser.parseBlockContents();
+
+        Type type = checker.checkTopLevel(*block);
+
+        // Modules the input pulled in still need checking and their globals defined
+        std::vector<Stmt> loaded;
+        checker.checkProgram(loaded);
+        interpreter.defineGlobals(loaded, checker.layout());
+        for (auto& stmt : loaded) program.push_back(std::move(stmt));
+
+        RaftValue value = interpreter.evaluateTopLevel(*block, checker.layout());
+
+        if (type != Type::Void) {
+            Output::standard().flush();
+            printValue(std::cout, value);
+            std::cout << '\n';
+        }
+    }
+};
+
+// Reads lines until the braces opened in them are closed
+static bool readInput(std::string& input) {
+    input.clear();
+    int depth = 0;
+    std::string line;
+
+    std::cout << "raft> " << std::flush;
+
+    while (std::getline(std::cin, line)) {
+        bool inString = false;
+        for (char c : line) {
+            if (c == '"') inString = !inString;
+            else if (!inString && c == '{') depth++;
+            else if (!inString && c == '}') depth--;
+        }
+
+        input += line;
+        input += '\n';
+
+        if (depth <= 0) return true;
+        std::cout << "...   " << std::flush;
+    }
+
+    return !input.empty();
+}
+
+int runRepl(const std::string& rootFile, const RunOptions& options) {
+    std::unique_ptr<ReplSession> session;
+
+    try {
+        session = std::make_unique<ReplSession>(rootFile, options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    std::cout << "Raft REPL. Prefix an input with :time to time it, :quit to leave.\n";
+
+    std::string input;
+    while (readInput(input)) {
+        size_t start = input.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) continue;
+        input.erase(0, start);
+
+        if (input.rfind(":quit", 0) == 0 || input.rfind(":q", 0) == 0) break;
+
+        bool timed = input.rfind(":time", 0) == 0;
+        if (timed) input.erase(0, 5);
+
+        session->evaluate(input, timed);
+    }
+
+    return 0;
+}
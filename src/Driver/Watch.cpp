@@ -0,0 +1,116 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "Driver/Driver.h"
+
+namespace fs = std::filesystem;
+
+// Waits for .rft files in a directory to be written, created, removed or renamed.
+// Uses inotify on Linux and falls back to polling modification times elsewhere.
+class DirectoryWatcher {
+public:
+    explicit DirectoryWatcher(const fs::path& dir) : dir(dir) {
+#ifdef __linux__
+        fd = inotify_init1(IN_CLOEXEC);
+        if (fd >= 0 && inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM) < 0) {
+            close(fd);
+            fd = -1;
+        }
+#endif
+        snapshot = scan();
+    }
+
+    ~DirectoryWatcher() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    void wait() {
+#ifdef __linux__
+        if (fd >= 0) {
+            while (!readEvents(-1)) {}
+
+            // Editors often save in several steps, let them settle into one rebuild
+            while (readEvents(50)) {}
+            return;
+        }
+#endif
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+            auto current = scan();
+            if (current != snapshot) {
+                snapshot = std::move(current);
+                return;
+            }
+        }
+    }
+
+private:
+    fs::path dir;
+    std::map<fs::path, fs::file_time_type> snapshot;
+
+    std::map<fs::path, fs::file_time_type> scan() {
+        std::map<fs::path, fs::file_time_type> files;
+        std::error_code ec;
+
+        for (const auto& entry : fs::directory_iterator(dir, ec)) {
+            if (entry.path().extension() == ".rft") files[entry.path()] = entry.last_write_time(ec);
+        }
+
+        return files;
+    }
+
+#ifdef __linux__
+    int fd = -1;
+
+    // Returns true if any event within the timeout concerned a .rft file
+    bool readEvents(int timeoutMs) {
+        pollfd pfd{ fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeoutMs) <= 0) return false;
+
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        bool relevant = false;
+
+        for (ssize_t offset = 0; offset < length;) {
+            auto* event = reinterpret_cast<inotify_event*>(buffer + offset);
+            if (event->len > 0 && fs::path(event->name).extension() == ".rft") relevant = true;
+            offset += sizeof(inotify_event) + event->len;
+        }
+
+        return relevant;
+    }
+#endif
+};
+
+int watchFile(const std::string& entryFilePath, const RunOptions& options) {
+    ModuleLoader loader(entryFilePath);
+    DirectoryWatcher watcher(loader.directory());
+
+    for (;;) {
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            compileAndRun(loader, options);
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+        }
+
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        std::cerr << "[watch] ran in " << elapsed.count() << " ms, re-parsed "
+                  << loader.filesParsed() << " of " << loader.filesLoaded() << " files. Waiting for changes...\n";
+
+        watcher.wait();
+    }
+}
@@ -0,0 +1,115 @@
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <io.h>
+#define RAFT_ISATTY(file) _isatty(_fileno(file))
+#else
+#include <unistd.h>
+#define RAFT_ISATTY(file) isatty(fileno(file))
+#endif
+
+#include "IO/Console.h"
+
+Output& Output::standard() {
+    static Output output(stdout, [] {
+        if (const char* mode = std::getenv("RAFT_STDOUT")) {
+            if (std::strcmp(mode, "line") == 0) return true;
+            if (std::strcmp(mode, "block") == 0) return false;
+        }
+
+        return RAFT_ISATTY(stdout) != 0;
+    }());
+
+    return output;
+}
+
+Output::Output(std::FILE* target, bool lineBuffered) : target(target), lineAtATime(lineBuffered) {
+    buffer.reserve(Capacity);
+}
+
+// The standard Output is a function static, so this runs at exit, before stdio is closed
+Output::~Output() {
+    flush();
+}
+
+void Output::print(const std::vector<RaftValue>& values, bool newline) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (const auto& value : values) append(value);
+    if (newline) buffer += '\n';
+
+    if (buffer.size() >= Capacity || (newline && lineAtATime)) drain();
+}
+
+void Output::write(std::string_view text) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    buffer += text;
+    if (buffer.size() >= Capacity || lineAtATime) drain();
+}
+
+void Output::flush() {
+    std::lock_guard<std::mutex> guard(lock);
+    drain();
+}
+
+void Output::redirect(std::FILE* to) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    drain();
+    target = to;
+}
+
+// Scalars are formatted straight into the buffer; doubles as %g, which is how streams show them
+void Output::append(const RaftValue& value) {
+    if (auto* s = std::get_if<std::string>(&value)) {
+        buffer += *s;
+    } else if (auto* i = std::get_if<int64_t>(&value)) {
+        char digits[24];
+        buffer.append(digits, std::to_chars(digits, digits + sizeof digits, *i).ptr);
+    } else if (auto* d = std::get_if<double>(&value)) {
+        char digits[32];
+        buffer.append(digits, std::snprintf(digits, sizeof digits, "%g", *d));
+    } else if (auto* b = std::get_if<bool>(&value)) {
+        buffer += *b ? "true" : "false";
+    } else {
+        std::ostringstream text;
+        printValue(text, value);
+        buffer += text.str();
+    }
+}
+
+void Output::drain() {
+    if (buffer.empty()) return;
+
+    if (target) {
+        std::fwrite(buffer.data(), 1, buffer.size(), target);
+        std::fflush(target);
+    }
+
+    buffer.clear();
+}
+
+// Reads through the stdin FILE rather than a buffer of its own, so it never takes input that
+// std::cin (the REPL) would read next
+bool readLine(std::string& line) {
+    Output::standard().flush();
+    line.clear();
+
+    char chunk[4096];
+    while (std::fgets(chunk, sizeof chunk, stdin)) {
+        size_t length = std::strlen(chunk);
+
+        if (length > 0 && chunk[length - 1] == '\n') {
+            line.append(chunk, length - 1);
+            return true;
+        }
+
+        line.append(chunk, length);
+    }
+
+    return !line.empty();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Util/token.h"
+
+// Standard output for std.io. Everything printed is formatted into one buffer that is written out
+// in large blocks, rather than a stream insertion per argument. The buffer is written when it
+// fills, by std.io.flush, before std.io.input reads, when a run ends and at exit. When stdout is
+// a terminal it is also written at the end of every line, so output shows as it's printed;
+// RAFT_STDOUT=line or RAFT_STDOUT=block picks either behaviour regardless.
+//
+// Prints from par for threads are whole: one call's arguments are never split by another's.
+class Output {
+public:
+    static Output& standard();
+
+    ~Output();
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+
+    // The values the way std.io.print shows them, then a newline if asked
+    void print(const std::vector<RaftValue>& values, bool newline);
+    void write(std::string_view text);
+
+    void flush();
+
+    // Where the buffer is written; null discards it (raft_bench runs programs without printing)
+    void redirect(std::FILE* target);
+
+    bool lineBuffered() const { return lineAtATime; }
+
+private:
+    Output(std::FILE* target, bool lineBuffered);
+
+    static constexpr size_t Capacity = 64 * 1024;
+
+    std::mutex lock;
+    std::FILE* target;
+    bool lineAtATime;
+    std::string buffer;
+
+    void append(const RaftValue&);
+    void drain(); // With lock held
+};
+
+// A line of standard input without its newline, or false at the end of input. Pending output is
+// flushed first, so that a prompt printed without a newline shows before the program waits.
+bool readLine(std::string& line);
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "IO/File.h"
+
+namespace {
+    constexpr size_t MappedPiece = 4 * 1024 * 1024; // A multiple of any page size
+
+    [[noreturn]] void failOn(const std::string& what, const std::string& path) {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    struct FileCloser {
+        void operator()(std::FILE* file) const { std::fclose(file); }
+    };
+
+    std::string readBlocks(const std::string& path) {
+        std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "rb"));
+        if (!file) failOn("Could not open file:", path);
+
+        std::string text;
+        char block[64 * 1024];
+        while (size_t read = std::fread(block, 1, sizeof block, file.get())) text.append(block, read);
+
+        if (std::ferror(file.get())) failOn("Could not read file:", path);
+        return text;
+    }
+}
+
+std::string readFile(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) failOn("Could not open file:", path);
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        ::close(fd);
+        return readBlocks(path);
+    }
+
+    size_t length = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return readBlocks(path);
+
+    // Copied out front to back, so the kernel reads ahead; the pages already copied are let go of
+    // as it goes, so that the file isn't held in memory twice
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+    std::string text(length, '\0');
+    const char* from = static_cast<const char*>(mapped);
+
+    for (size_t done = 0; done < length;) {
+        size_t piece = std::min(length - done, MappedPiece);
+        std::memcpy(text.data() + done, from + done, piece);
+        ::madvise(const_cast<char*>(from) + done, piece, MADV_DONTNEED);
+        done += piece;
+    }
+
+    ::munmap(mapped, length);
+
+    return text;
+#else
+    return readBlocks(path);
+#endif
+}
+
+bool fileExists(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    std::fclose(file);
+    return true;
+}
+
+RaftFile::RaftFile(std::string path, Mode mode) : path(std::move(path)), mode(mode) {
+    const char* how = mode == Mode::Read ? "rb" : mode == Mode::Write ? "wb" : "ab";
+
+    file = std::fopen(this->path.c_str(), how);
+    if (!file) failOn("Could not open file:", this->path);
+
+    // The buffer here does what stdio's would, so stdio's is turned off rather than copied through
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    buffer.reserve(BlockSize);
+}
+
+RaftFile::~RaftFile() {
+    try {
+        close();
+    } catch (const std::runtime_error&) {
+        // Nothing to report a failed write to once the program has let go of the file
+    }
+}
+
+bool RaftFile::refill() {
+    buffer.erase(0, position);
+    position = 0;
+
+    size_t kept = buffer.size();
+    buffer.resize(kept + BlockSize);
+
+    size_t read = std::fread(buffer.data() + kept, 1, BlockSize, file);
+    buffer.resize(kept + read);
+
+    if (read == 0 && std::ferror(file)) failOn("Could not read file:", path);
+    return read > 0;
+}
+
+bool RaftFile::atEnd() {
+    if (mode != Mode::Read) return false;
+    return position == buffer.size() && !refill();
+}
+
+bool RaftFile::readLine(std::string& line) {
+    line.clear();
+    size_t searched = position;
+
+    for (;;) {
+        const char* start = buffer.data() + searched;
+        auto* newline = static_cast<const char*>(std::memchr(start, '\n', buffer.size() - searched));
+
+        if (newline) {
+            size_t end = newline - buffer.data();
+            line.assign(buffer, position, end - position);
+            position = end + 1;
+            break;
+        }
+
+        // Lines longer than the buffer grow it, since refill keeps the unread part
+        searched = buffer.size() - position;
+        if (!refill()) {
+            if (position == buffer.size()) return false;
+
+            line.assign(buffer, position);
+            position = buffer.size();
+            break;
+        }
+    }
+
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+}
+
+std::string RaftFile::readChunk(size_t size) {
+    std::string chunk;
+    chunk.reserve(std::min(size, BlockSize));
+
+    while (chunk.size() < size) {
+        if (position == buffer.size() && !refill()) break;
+
+        size_t take = std::min(size - chunk.size(), buffer.size() - position);
+        chunk.append(buffer, position, take);
+        position += take;
+    }
+
+    return chunk;
+}
+
+void RaftFile::write(std::string_view text) {
+    // A piece bigger than the buffer goes straight to the file rather than through it
+    if (buffer.size() + text.size() > BlockSize) {
+        flush();
+
+        if (text.size() >= BlockSize) {
+            if (std::fwrite(text.data(), 1, text.size(), file) != text.size()) failOn("Could not write file:", path);
+            return;
+        }
+    }
+
+    buffer += text;
+}
+
+void RaftFile::flush() {
+    if (!file || mode == Mode::Read || buffer.empty()) return;
+
+    bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    buffer.clear();
+    if (!written) failOn("Could not write file:", path);
+}
+
+void RaftFile::close() {
+    if (!file) return;
+
+    flush();
+    std::fclose(file);
+    file = nullptr;
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+    position = 0;
+}
+
+void printFile(std::ostream& out, const RaftFile& file) {
+    out << "<file " << file.path << ">";
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdio>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+// A whole file's contents. Regular files are mapped into memory and copied out in one go; pipes
+// and other files that can't be mapped are read in blocks.
+std::string readFile(const std::string& path);
+
+bool fileExists(const std::string& path);
+
+// A std.fs file, open for reading or for writing. Reading goes through a block-sized buffer, so
+// lines and chunks come off a file of any size in constant memory; writes are collected in a
+// buffer of the same size and written out when it fills, by std.fs.flush, and on close. Files
+// are shared by reference like builders, and closed when the last reference goes if they
+// weren't before.
+class RaftFile {
+public:
+    enum class Mode { Read, Write, Append };
+
+    RaftFile(std::string path, Mode mode);
+    ~RaftFile();
+
+    RaftFile(const RaftFile&) = delete;
+    RaftFile& operator=(const RaftFile&) = delete;
+
+    const std::string path;
+    const Mode mode;
+
+    bool isOpen() const { return file != nullptr; }
+
+    // Whether everything has been read; false for files open for writing
+    bool atEnd();
+
+    // The next line without its line ending (\n or \r\n), or false at the end of the file
+    bool readLine(std::string& line);
+
+    // Up to size bytes; fewer only at the end of the file
+    std::string readChunk(size_t size);
+
+    void write(std::string_view text);
+    void flush();
+    void close();
+
+private:
+    static constexpr size_t BlockSize = 64 * 1024;
+
+    std::FILE* file;
+    std::string buffer;
+    size_t position = 0; // Reading: where the unread part of buffer starts
+
+    bool refill();
+};
+
+void printFile(std::ostream&, const RaftFile&);
@@ -1,57 +1,90 @@
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
+#include <vector>
 
 #include "Util/token.h"
 #include "AST/AST.h"
+#include "Profiler/Stats.h"
 
-struct RaftVariable {
-    RaftValue value;
-    bool isMutable;
-    std::string declaredType;
-};
-
+// Runtime storage for variables. The TypeChecker gives every variable a slot:
+// globals live in their own table, locals live in one contiguous value stack
+// where each call's frame starts at `base`. Blocks and calls allocate nothing
+// once the stack has grown to the program's deepest frame.
 class Environment {
 public:
-    explicit Environment(std::shared_ptr<Environment> parent = nullptr)
-        : parent(std::move(parent)) {}
+    Environment() { stack.resize(256); }
 
-    void define(const std::string& name, RaftValue value, bool is_mutable = false, std::string declared_type = "") {
-        values[name] = std::move(
-            RaftVariable {
-                std::move(value),
-                is_mutable,
-                std::move(declared_type)
-            }
-        );
+    void resizeGlobals(size_t count) {
+        globals->resize(count);
     }
 
-    RaftValue lookup(const std::string& name) {
-        auto it = values.find(name);
+    RaftValue& global(uint32_t slot) {
+        runtimeStats.globalAccesses++;
+        return (*globals)[slot];
+    }
 
-        if (it != values.end()) return it->second.value;
+    // For a par for worker: the owner's globals, and a copy of the frame the loop runs in as its
+    // only frame. The owner must outlive this environment and not resize its globals meanwhile.
+    void share(Environment& owner, const std::vector<RaftValue>& frame) {
+        globals = owner.globals;
+        reset();
+        reserve(frame.size());
+        std::copy(frame.begin(), frame.end(), stack.begin());
+        top = frame.size();
+    }
 
-        if (parent) return parent->lookup(name);
+    // The slots of the current frame and anything pushed above it
+    std::vector<RaftValue> frame() const {
+        return std::vector<RaftValue>(stack.begin() + base, stack.begin() + top);
+    }
 
-        throw std::runtime_error("Undefined variable: " + name);
+    RaftValue& local(uint32_t slot) {
+        runtimeStats.localAccesses++;
+        return stack[base + slot];
     }
 
-    void assign(const std::string& name, RaftValue value) {
-        auto it = values.find(name);
+    // Pushes a value just above the current frame. Call arguments are pushed this way
+    // so that they already sit in the parameter slots of the callee's frame.
+    void push(RaftValue value) {
+        reserve(top + 1);
+        stack[top++] = std::move(value);
+    }
 
-        if (it != values.end()) {
-            if (!it->second.isMutable) throw std::runtime_error(name + " is not a mutable value");
+    size_t height() const { return top; }
 
-            it->second.value = std::move(value);
-            return;
-        }
+    // Makes the values pushed since frameBase the start of a new frame, returning the caller's base
+    size_t enter(size_t frameBase, uint32_t frameSize) {
+        size_t previousBase = base;
+        base = frameBase;
+        top = base + frameSize;
+        reserve(top);
 
-        if (parent) { parent->assign(name, std::move(value)); return; }
-        
-        throw std::runtime_error("Undefined variable: " + name);
+        return previousBase;
+    }
+
+    void leave(size_t previousBase) {
+        top = base;
+        base = previousBase;
+    }
+
+    // Drops every frame, e.g. the ones a runtime error unwound past
+    void reset() {
+        base = 0;
+        top = 0;
     }
 
 private:
-    std::unordered_map<std::string, RaftVariable> values;
-    std::shared_ptr<Environment> parent;
-};
\ No newline at end of file
+    std::vector<RaftValue> ownGlobals;
+    std::vector<RaftValue>* globals = &ownGlobals;
+    std::vector<RaftValue> stack;
+    size_t base = 0;
+    size_t top = 0;
+
+    void reserve(size_t size) {
+        if (size > stack.size()) {
+            runtimeStats.stackGrowths++;
+            stack.resize(size * 2);
+        }
+    }
+};
@@ -1,7 +1,13 @@
 #include "Interpreter.h"
 #include "AST/AST.h"
 #include "Interpreter/Environment.h"
+#include "Profiler/Profiler.h"
+#include "Profiler/Trace.h"
+#include "Profiler/Allocations.h"
+#include "Parallel/WorkPool.h"
+#include "Util/map.h"
 
+#include <algorithm>
 #include <variant>
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
@@ -14,6 +20,27 @@ struct ContinueException {};
 // Helper for function return
 struct ReturnException { RaftValue value; };
 
+Interpreter::Interpreter(Resolver* resolver) : resolver(resolver) {
+    nativeHost = this;
+}
+
+Interpreter::~Interpreter() {
+    if (nativeHost == this) nativeHost = nullptr;
+}
+
+const FunctionInfo& Interpreter::findFunction(const std::string& qualifiedName) {
+    const FunctionInfo* info = resolver ? resolver->findFunction(qualifiedName) : nullptr;
+    if (!info) throw std::runtime_error("Cannot find function: " + qualifiedName);
+
+    return *info;
+}
+
+RaftValue Interpreter::call(const FunctionInfo& info, std::vector<RaftValue> args) {
+    if (info.native_def) return info.native_def->impl(args);
+
+    return callUserFn(info.decl, args);
+}
+
 bool Interpreter::isDouble(const RaftValue& val) {
     return std::holds_alternative<double>(val);
 }
@@ -33,27 +60,221 @@ double Interpreter::asDouble(const RaftValue& val) {
     throw std::runtime_error("Expected a numeric value");
 }
 
-RaftValue Interpreter::callUserFn(const FunctionDecl* fn, const std::vector<RaftValue>& args) {
-    auto previous = currentEnv;
-    currentEnv = std::make_shared<Environment>(globalEnv);
+// Array variables are read in place, so indexing doesn't copy (and reference count) the array
+// pointer. Other array operands have already been evaluated into temporary.
+const RaftArray& Interpreter::arrayOperand(const Expr& expr, const RaftValue& temporary) {
+    if (auto* var = std::get_if<VariableExpr>(&expr)) {
+        const RaftValue& value = var->slot.global ? env.global(var->slot.index) : env.local(var->slot.index);
+        return *std::get<std::shared_ptr<RaftArray>>(value);
+    }
+
+    return *std::get<std::shared_ptr<RaftArray>>(temporary);
+}
+
+size_t Interpreter::elementIndex(const RaftArray& array, int64_t index, bool checked) {
+    if (!checked) {
+        runtimeStats.uncheckedIndexes++;
+        return static_cast<size_t>(index);
+    }
+
+    runtimeStats.boundsChecks++;
+    if (static_cast<uint64_t>(index) >= array.size()) {
+        throw std::runtime_error("Index " + std::to_string(index) + " is out of bounds for an array of length " + std::to_string(array.size()));
+    }
+
+    return static_cast<size_t>(index);
+}
+
+// Where the fields of a struct operand are: struct variables and elements of struct arrays are
+// read in place, and a nested struct is found inside its parent. Other operands are evaluated
+// into temporary, which keeps them (or the array they are read from) alive.
+const uint8_t* Interpreter::structBytes(const Expr& expr, RaftValue& temporary) {
+    if (auto* var = std::get_if<VariableExpr>(&expr)) {
+        const RaftValue& value = var->slot.global ? env.global(var->slot.index) : env.local(var->slot.index);
+        return std::get<std::shared_ptr<RaftStruct>>(value)->bytes.data();
+    }
+
+    if (auto* field = std::get_if<std::unique_ptr<FieldExpr>>(&expr)) {
+        return structBytes((*field)->object, temporary) + (*field)->resolved->offset;
+    }
+
+    if (auto* element = std::get_if<std::unique_ptr<IndexExpr>>(&expr)) {
+        const IndexExpr& e = **element;
+        if (!std::holds_alternative<VariableExpr>(e.array)) temporary = evaluate(e.array);
 
+        int64_t position = std::get<int64_t>(evaluate(e.index));
+
+        const RaftArray& array = arrayOperand(e.array, temporary);
+        return array.structAt(elementIndex(array, position, e.checked));
+    }
+
+    temporary = evaluate(expr);
+    return std::get<std::shared_ptr<RaftStruct>>(temporary)->bytes.data();
+}
+
+RaftValue Interpreter::callUserFn(const FunctionDecl* fn, const std::vector<RaftValue>& args) {
     if (fn->params.size() != args.size())
         throw std::runtime_error("Number of Arguments in call does not match with function declaration");
 
-    for (size_t i = 0; i < fn->params.size(); i++)
-        currentEnv->define(fn->params[i].name, args[i]);
+    size_t frameBase = env.height();
+    for (const auto& arg : args) env.push(arg);
+
+    return callUserFn(fn, frameBase);
+}
+
+// Arguments have already been pushed starting at frameBase (the TypeChecker has checked their count)
+RaftValue Interpreter::callUserFn(const FunctionDecl* fn, size_t frameBase) {
+    size_t previousBase = env.enter(frameBase, fn->frameSize);
+    callstack::push(fn);
+    runtimeStats.userCalls++;
+    if (tracer.calls && !worker) tracer.enter(fn);
 
     RaftValue result{std::monostate{}};
     try {
         result = evalBlockExpr(*fn->body);
     } catch (ReturnException& ret) {
-        result = ret.value;
+        result = std::move(ret.value);
     }
 
-    currentEnv = previous;
+    if (tracer.calls && !worker) tracer.exit(fn);
+    callstack::pop();
+    env.leave(previousBase);
     return result;
 }
 
+void Reduction::add(const RaftValue& value) {
+    if (!doubles) {
+        combine(std::get<int64_t>(value), 0);
+        return;
+    }
+
+    auto* real = std::get_if<double>(&value);
+    combine(0, real ? *real : static_cast<double>(std::get<int64_t>(value)));
+}
+
+void Reduction::add(const Reduction& other) {
+    if (!other.empty) combine(other.integer, other.real);
+}
+
+void Reduction::combine(int64_t i, double d) {
+    if (empty) {
+        integer = i;
+        real = d;
+        empty = false;
+        return;
+    }
+
+    switch (op) {
+        case ReduceOp::Sum: integer += i; real += d; break;
+        case ReduceOp::Product: integer *= i; real *= d; break;
+        case ReduceOp::Min: integer = std::min(integer, i); real = std::min(real, d); break;
+        case ReduceOp::Max: integer = std::max(integer, i); real = std::max(real, d); break;
+        case ReduceOp::None: break;
+    }
+}
+
+RaftValue Reduction::value() const {
+    if (op == ReduceOp::None) return std::monostate{};
+
+    if (empty) {
+        if (op == ReduceOp::Min || op == ReduceOp::Max) throw std::runtime_error("reduce min and reduce max need at least one value");
+
+        int64_t identity = op == ReduceOp::Product ? 1 : 0;
+        return doubles ? RaftValue{ static_cast<double>(identity) } : RaftValue{ identity };
+    }
+
+    return doubles ? RaftValue{ real } : RaftValue{ integer };
+}
+
+// The iterations are cut into a few chunks per thread and run on the WorkPool. Every pool thread
+// gets an interpreter of its own, sharing this one's globals, with a copy of the frame the loop
+// is in; this thread runs chunks too, on its own frame. Reductions are combined in chunk order,
+// so for a given number of threads a double reduction always rounds the same way.
+RaftValue Interpreter::evalParallelFor(const ForExpr& loop) {
+    constexpr int64_t ChunksPerThread = 8;
+
+    RaftValue source;
+    int64_t start = 0;
+    int64_t end = 0;
+
+    if (loop.end) {
+        start = std::get<int64_t>(evaluate(loop.start));
+        end = std::get<int64_t>(evaluate(*loop.end));
+    } else {
+        source = evaluate(loop.start);
+        end = static_cast<int64_t>(std::get<std::shared_ptr<RaftArray>>(source)->size());
+    }
+
+    Reduction result{ loop.reduce, loop.reducesDoubles };
+    if (end <= start) return result.value();
+
+    WorkPool& pool = WorkPool::global();
+    uint64_t count = static_cast<uint64_t>(end) - static_cast<uint64_t>(start);
+    uint64_t chunks = std::min<uint64_t>(count, pool.size() * ChunksPerThread);
+
+    std::vector<RaftValue> frame = env.frame();
+    std::vector<std::unique_ptr<Interpreter>> workers(pool.size());
+    std::vector<RuntimeStats> workerStats(pool.size());
+    std::vector<Reduction> partials(chunks, result);
+
+#ifdef RAFT_ALLOC_PROFILE
+    int phase = allocationProfile::phase;
+#endif
+
+    pool.run(chunks, [&](size_t chunk, size_t thread) {
+        // Chunk c covers [c * count / chunks, (c + 1) * count / chunks) without overflowing
+        auto offset = [&](uint64_t c) { return static_cast<int64_t>(c * (count / chunks) + std::min(c, count % chunks)); };
+        int64_t from = start + offset(chunk);
+        int64_t to = start + offset(chunk + 1);
+
+        if (thread == 0) {
+            runIterations(loop, source, from, to, partials[chunk]);
+            return;
+        }
+
+        if (!workers[thread]) {
+            workers[thread] = std::make_unique<Interpreter>(resolver);
+            workers[thread]->worker = true;
+            workers[thread]->env.share(env, frame);
+        }
+
+#ifdef RAFT_ALLOC_PROFILE
+        allocationProfile::phase = phase;
+#endif
+
+        // A pool thread's counters are never reported, so they just collect this chunk's
+        runtimeStats = {};
+        workers[thread]->runIterations(loop, source, from, to, partials[chunk]);
+        workerStats[thread] += runtimeStats;
+    });
+
+    for (const auto& stats : workerStats) runtimeStats += stats;
+    for (const auto& partial : partials) result.add(partial);
+
+    return result.value();
+}
+
+// Iterations [from, to) of a for loop: counter values, or indexes into the array in source
+void Interpreter::runIterations(const ForExpr& loop, const RaftValue& source, int64_t from, int64_t to, Reduction& result) {
+    const RaftArray* array = loop.end ? nullptr : std::get<std::shared_ptr<RaftArray>>(source).get();
+
+    for (int64_t i = from; i < to; i++) {
+        if (array) {
+            if (array->kind == ElementKind::String) runtimeStats.stringCopies++;
+            env.local(loop.slot.index) = array->get(static_cast<size_t>(i));
+        } else {
+            env.local(loop.slot.index) = i;
+        }
+
+        try {
+            RaftValue value = evalBlockExpr(*loop.body);
+            if (loop.reduce != ReduceOp::None) result.add(value);
+        } catch (ContinueException&) {
+            continue;
+        }
+    }
+}
+
 RaftValue Interpreter::applyBinOp(TokenType op, const RaftValue& left, const RaftValue& right) {
     // Handles logical expressions
     if (isBool(left) && isBool(right)) {
@@ -121,6 +342,54 @@ RaftValue Interpreter::applyBinOp(TokenType op, const RaftValue& left, const Raf
     throw std::runtime_error("Unknown operator");
 }
 
+// x += value and the like, on the variable's own storage: no temporary result is built and moved
+// back, and += on a string appends to it rather than copying it
+void Interpreter::applyCompoundAssign(const AssignmentStmt& s, RaftValue& target, const RaftValue& value) {
+    switch (s.kind) {
+        case ElementKind::Int: {
+            int64_t& x = std::get<int64_t>(target);
+            int64_t v = std::get<int64_t>(value);
+
+            switch (s.op) {
+                case TokenType::PLUS_EQUAL: case TokenType::PLUS_PLUS: x += v; return;
+                case TokenType::MINUS_EQUAL: case TokenType::MINUS_MINUS: x -= v; return;
+                case TokenType::MUL_EQUAL: x *= v; return;
+                case TokenType::DIV_EQUAL:
+                    if (v == 0) throw std::runtime_error("Division by zero");
+                    x /= v;
+                    return;
+                default: break;
+            }
+            break;
+        }
+
+        case ElementKind::Double: {
+            // A double variable may have been given an int
+            if (auto* i = std::get_if<int64_t>(&target)) target = static_cast<double>(*i);
+
+            double& x = std::get<double>(target);
+            double v = asDouble(value);
+
+            switch (s.op) {
+                case TokenType::PLUS_EQUAL: case TokenType::PLUS_PLUS: x += v; return;
+                case TokenType::MINUS_EQUAL: case TokenType::MINUS_MINUS: x -= v; return;
+                case TokenType::MUL_EQUAL: x *= v; return;
+                case TokenType::DIV_EQUAL: x /= v; return;
+                default: break;
+            }
+            break;
+        }
+
+        case ElementKind::String:
+            std::get<std::string>(target) += std::get<std::string>(value);
+            return;
+
+        default: break;
+    }
+
+    throw std::runtime_error("Unknown operator");
+}
+
 RaftValue Interpreter::applyUnaryOp(TokenType op, const RaftValue& operand) {
     switch (op)
     {
@@ -138,28 +407,59 @@ RaftValue Interpreter::applyUnaryOp(TokenType op, const RaftValue& operand) {
 }
 
 RaftValue Interpreter::evalBlockExpr(const BlockExpr& block) {
-    auto previous = currentEnv;
-    currentEnv = std::make_shared<Environment>(previous);
-
+    // Block locals already have their own slots in the frame, so there is no scope to set up
     for (const auto& stmt : block.statements) execute(stmt);
 
-    RaftValue result = block.tail.has_value() ? evaluate(**block.tail) : RaftValue{std::monostate{}};
-
-    currentEnv = previous;
-    return result;
+    return block.tail.has_value() ? evaluate(**block.tail) : RaftValue{std::monostate{}};
 }
 
+// Runtime errors are prefixed with the position of the innermost node that has one.
+// The handlers cost nothing until something throws. The node's position is only recorded
+// for the profiler while it runs.
 RaftValue Interpreter::evaluate(const Expr& expression) {
+    RAFT_ALLOCATION_NODE(nodeKind(expression));
+
+    try {
+        if (callstack::tracksPositions) return evaluateProfiled(expression);
+        return evaluateNode(expression);
+    } catch (const std::runtime_error&) {
+        rethrowAt(positionOf(expression));
+    }
+}
+
+void Interpreter::execute(const Stmt& stmt) {
+    RAFT_ALLOCATION_NODE(nodeKind(stmt));
+
+    try {
+        if (callstack::tracksPositions) executeProfiled(stmt);
+        else executeNode(stmt);
+    } catch (const std::runtime_error&) {
+        rethrowAt(positionOf(stmt));
+    }
+}
+
+// Separate from evaluate and execute so that they stay small when nothing is profiling
+RaftValue Interpreter::evaluateProfiled(const Expr& expression) {
+    callstack::PositionScope position(positionOf(expression));
+    return evaluateNode(expression);
+}
+
+void Interpreter::executeProfiled(const Stmt& stmt) {
+    callstack::PositionScope position(positionOf(stmt));
+    executeNode(stmt);
+}
+
+RaftValue Interpreter::evaluateNode(const Expr& expression) {
     return std::visit(overloaded {
-        [&](LiteralExpr expr) -> RaftValue {
-            if (isString(expr.val)) return std::get<std::string>(expr.val);
-            if (isDouble(expr.val)) return std::get<double>(expr.val);
-            if (isBool(expr.val)) return std::get<bool>(expr.val);
-            
-            return std::get<int64_t>(expr.val);
+        [&](const LiteralExpr& expr) -> RaftValue {
+            if (isString(expr.val)) runtimeStats.stringCopies++;
+            return expr.val;
         },
-        [&](VariableExpr expr) -> RaftValue { 
-            return currentEnv->lookup(expr.id);
+        [&](const VariableExpr& expr) -> RaftValue {
+            const RaftValue& value = expr.slot.global ? env.global(expr.slot.index) : env.local(expr.slot.index);
+            if (isString(value)) runtimeStats.stringCopies++;
+
+            return value;
         },
         [&](const std::unique_ptr<UnaryExpr>& expr) -> RaftValue {
             RaftValue operand = evaluate(expr->operand);
@@ -173,12 +473,29 @@ RaftValue Interpreter::evaluate(const Expr& expression) {
             return applyBinOp(expr->op, left, right);
         },
         [&](const std::unique_ptr<CallExpr>& expr) -> RaftValue {
-            std::vector<RaftValue> argVals;
+            if (expr->resolved->native_def) {
+                std::vector<RaftValue> argVals;
+                argVals.reserve(expr->arguments.size());
+
+                for (auto& arg : expr->arguments) argVals.push_back(evaluate(arg));
+
+                callstack::push(expr->resolved->native_def);
+                runtimeStats.nativeCalls++;
+                if (tracer.calls && !worker) tracer.enter(expr->resolved->native_def);
 
-            for (auto& arg : expr->arguments) argVals.push_back(evaluate(arg));
+                RaftValue result = expr->resolved->native_def->impl(argVals);
 
-            if (expr->resolved->native_def) return expr->resolved->native_def->impl(argVals);
-            return callUserFn(expr->resolved->decl, argVals);
+                if (tracer.calls && !worker) tracer.exit(expr->resolved->native_def);
+                callstack::pop();
+
+                return result;
+            }
+
+            // Evaluate arguments straight into the callee's parameter slots
+            size_t frameBase = env.height();
+            for (auto& arg : expr->arguments) env.push(evaluate(arg));
+
+            return callUserFn(expr->resolved->decl, frameBase);
         },
 
         [&](const std::unique_ptr<IfExpr>& s) {
@@ -214,32 +531,202 @@ RaftValue Interpreter::evaluate(const Expr& expression) {
             return value;
         },
 
+        // The counter lives in a plain int64_t and is only copied into its slot, so an
+        // iteration evaluates no condition and allocates nothing
+        [&](const std::unique_ptr<ForExpr>& s) -> RaftValue {
+            if (s->parallel) return evalParallelFor(*s);
+
+            if (!s->end) {
+                RaftValue source = evaluate(s->start); // Keeps the array alive should the body reassign its variable
+                const RaftArray& array = *std::get<std::shared_ptr<RaftArray>>(source);
+
+                for (size_t i = 0; i < array.size(); i++) {
+                    if (array.kind == ElementKind::String) runtimeStats.stringCopies++;
+                    env.local(s->slot.index) = array.get(i);
+
+                    try {
+                        evalBlockExpr(*s->body);
+                    } catch (BreakException&) {
+                        break;
+                    } catch (ContinueException&) {
+                        continue;
+                    }
+                }
+
+                return std::monostate{};
+            }
+
+            int64_t start = std::get<int64_t>(evaluate(s->start));
+            int64_t end = std::get<int64_t>(evaluate(*s->end));
+
+            for (int64_t i = start; i < end; i++) {
+                env.local(s->slot.index) = i;
+
+                try {
+                    evalBlockExpr(*s->body);
+                } catch (BreakException&) {
+                    break;
+                } catch (ContinueException&) {
+                    continue;
+                }
+            }
+
+            return std::monostate{};
+        },
+
+        [&](const std::unique_ptr<LoopExpr>& s) -> RaftValue {
+            for (;;) {
+                try {
+                    evalBlockExpr(*s->body);
+                } catch (BreakException&) {
+                    break;
+                } catch (ContinueException&) {
+                    continue;
+                }
+            }
+
+            return std::monostate{};
+        },
+
         [&](const std::unique_ptr<BlockExpr>& s) {
             return evalBlockExpr(*s);
+        },
+
+        [&](const std::unique_ptr<IndexExpr>& expr) -> RaftValue {
+            RaftValue temporary;
+            if (!std::holds_alternative<VariableExpr>(expr->array)) temporary = evaluate(expr->array);
+
+            // The index is evaluated before a variable's array is looked up: it may call functions that grow the stack
+            int64_t position = std::get<int64_t>(evaluate(expr->index));
+
+            const RaftArray& array = arrayOperand(expr->array, temporary);
+            size_t index = elementIndex(array, position, expr->checked);
+
+            if (array.kind == ElementKind::String) runtimeStats.stringCopies++;
+            return array.get(index);
+        },
+
+        [&](const std::unique_ptr<ArrayExpr>& expr) -> RaftValue {
+            if (expr->count) {
+                RaftValue fill = evaluate(expr->elements.front());
+                int64_t count = std::get<int64_t>(evaluate(*expr->count));
+                if (count < 0) throw std::runtime_error("Array length cannot be negative: " + std::to_string(count));
+
+                if (expr->kind == ElementKind::Double && !isDouble(fill)) fill = asDouble(fill);
+                return std::make_shared<RaftArray>(expr->kind, static_cast<size_t>(count), fill);
+            }
+
+            // Elements are stored straight into the typed buffer. A struct array has no default element
+            // and is filled with its first one
+            RaftValue first = evaluate(expr->elements.front());
+            RaftValue fill = expr->kind == ElementKind::Struct ? first : defaultElement(expr->kind);
+
+            auto array = std::make_shared<RaftArray>(expr->kind, expr->elements.size(), fill);
+            array->set(0, std::move(first));
+            for (size_t i = 1; i < expr->elements.size(); i++) array->set(i, evaluate(expr->elements[i]));
+
+            return array;
+        },
+
+        [&](const std::unique_ptr<StructExpr>& expr) -> RaftValue {
+            auto value = std::make_shared<RaftStruct>(expr->layout);
+
+            for (const auto& field : expr->fields) {
+                const auto& f = *field.resolved;
+                writeField(value->bytes.data() + f.offset, f.kind, f.layout, evaluate(field.value));
+            }
+
+            return value;
+        },
+
+        [&](const std::unique_ptr<FieldExpr>& expr) -> RaftValue {
+            RaftValue temporary;
+            const uint8_t* bytes = structBytes(expr->object, temporary);
+
+            const auto& f = *expr->resolved;
+            return readField(bytes + f.offset, f.kind, f.layout);
+        },
+
+        [&](const std::unique_ptr<MapExpr>& expr) -> RaftValue {
+            auto map = std::make_shared<RaftMap>(expr->keyKind, expr->valueKind);
+            map->reserve(expr->entries.size());
+
+            for (const auto& entry : expr->entries) {
+                RaftValue key = evaluate(entry.key);
+                map->set(key, evaluate(entry.value));
+            }
+
+            return map;
         }
     }, expression);
 }
 
-void Interpreter::execute(const Stmt& stmt) {
+void Interpreter::executeNode(const Stmt& stmt) {
     std::visit(overloaded {
         [&](const VarDeclStmt& s) {
             RaftValue val = evaluate(s.value);
-            currentEnv->define(s.name, val, s.isMutable);
+            env.local(s.slot.index) = std::move(val);
         },
 
         [&](const AssignmentStmt& s) {
             RaftValue val = evaluate(s.value);
+            RaftValue& target = s.slot.global ? env.global(s.slot.index) : env.local(s.slot.index);
+
+            if (s.op == TokenType::EQUAL) target = std::move(val);
+            else applyCompoundAssign(s, target, val);
+        },
+
+        [&](const IndexAssignStmt& s) {
+            int64_t position = std::get<int64_t>(evaluate(s.index));
+            RaftValue value = evaluate(s.value);
 
-            currentEnv->assign(s.id, val);
+            RaftValue& target = s.slot.global ? env.global(s.slot.index) : env.local(s.slot.index);
+            RaftArray& array = *std::get<std::shared_ptr<RaftArray>>(target);
+
+            array.set(elementIndex(array, position, s.checked), std::move(value));
         },
 
+        // The field is written where it is. A struct variable whose value is shared first gets a copy
+        // of its own, which is what keeps structs values
+        [&](const FieldAssignStmt& s) {
+            int64_t position = s.index ? std::get<int64_t>(evaluate(*s.index)) : 0;
+            RaftValue value = evaluate(s.value);
+
+            RaftValue& target = s.slot.global ? env.global(s.slot.index) : env.local(s.slot.index);
+            uint8_t* bytes;
+
+            if (s.index) {
+                RaftArray& array = *std::get<std::shared_ptr<RaftArray>>(target);
+                bytes = array.structAt(elementIndex(array, position, s.checked));
+            } else {
+                auto& object = std::get<std::shared_ptr<RaftStruct>>(target);
+                if (object.use_count() > 1) object = std::make_shared<RaftStruct>(object->layout, object->bytes.data());
+
+                bytes = object->bytes.data();
+            }
+
+            writeField(bytes + s.offset, s.resolved->kind, s.resolved->layout, value);
+        },
+
+        [&](const std::unique_ptr<StructDecl>&) {}, // Laid out by the Resolver
+
         [&](const std::unique_ptr<FunctionDecl>& s) {}, // Resolver has already handled 
 
-        [&](const BreakStmt& s) { throw BreakException{}; },
+        [&](const BreakStmt& s) {
+            runtimeStats.controlFlowThrows++;
+            throw BreakException{};
+        },
 
-        [&](const ContinueStmt& s) { throw ContinueException{}; },
+        [&](const ContinueStmt& s) {
+            runtimeStats.controlFlowThrows++;
+            throw ContinueException{};
+        },
 
-        [&](const ReturnStmt& s) { throw ReturnException{ evaluate(s.value) }; },
+        [&](const ReturnStmt& s) {
+            RaftValue value = evaluate(s.value);
+            runtimeStats.controlFlowThrows++;
+            throw ReturnException{ std::move(value) };
+        },
 
         [&](const ExprStmt& s) {
             auto value = evaluate(s.expression);
@@ -261,19 +748,18 @@ void Interpreter::execute(const std::vector<Stmt>& statements) {
     }
 }
 
-void Interpreter::executeProgram(const std::vector<Stmt>& program) {
-    for (const auto& stmt : program) {
-        // This loop only checks top level statements
+// Runs the initializers of top level and module level lets in declaration order
+void Interpreter::runGlobalInitializers(const std::vector<Stmt>& statements) {
+    for (const auto& stmt : statements) {
         std::visit(overloaded{
             [&](const VarDeclStmt& s) {
                 RaftValue val = evaluate(s.value);
-                currentEnv->define(s.name, val, s.isMutable);
+                env.global(s.slot.index) = std::move(val);
             },
             [&](const ImportStmt&) { /* handled by Resolver, nothing to do */ },
-            [&](const std::unique_ptr<FunctionDecl>& f) {
-                if (f->name == "main") mainFn = f.get();
-            },
-            [&](const std::unique_ptr<ModuleDecl>& m) { /* registered by Resolver, nothing to do */ },
+            [&](const std::unique_ptr<FunctionDecl>&) { /* registered by Resolver, nothing to do */ },
+            [&](const std::unique_ptr<StructDecl>&) { /* laid out by Resolver, nothing to do */ },
+            [&](const std::unique_ptr<ModuleDecl>& m) { runGlobalInitializers(m->body); },
             [](const auto&) {
                 throw std::runtime_error(
                     "Only declarations (let, fn, mod, import) are allowed at the top level — "
@@ -281,6 +767,41 @@ void Interpreter::executeProgram(const std::vector<Stmt>& program) {
             }
         }, stmt);
     }
+}
+
+void Interpreter::defineGlobals(const std::vector<Stmt>& statements, const ProgramLayout& layout) {
+    env.resizeGlobals(layout.globalCount);
+
+    // Blocks inside global initializers get a frame of their own
+    size_t previousBase = env.enter(env.height(), layout.initFrameSize);
+    runGlobalInitializers(statements);
+    env.leave(previousBase);
+}
+
+RaftValue Interpreter::evaluateTopLevel(const BlockExpr& block, const ProgramLayout& layout) {
+    env.resizeGlobals(layout.globalCount);
+
+    size_t previousBase = env.enter(env.height(), layout.initFrameSize);
+    RaftValue result = evalBlockExpr(block);
+    env.leave(previousBase);
+
+    return result;
+}
+
+void Interpreter::reset() {
+    env.reset();
+    callstack::reset();
+}
+
+void Interpreter::executeProgram(const std::vector<Stmt>& program, const ProgramLayout& layout) {
+    callstack::reset();
+    defineGlobals(program, layout);
+
+    for (const auto& stmt : program) {
+        if (auto* f = std::get_if<std::unique_ptr<FunctionDecl>>(&stmt)) {
+            if ((*f)->name == intern("main")) mainFn = f->get();
+        }
+    }
 
     callUserFn(mainFn, {}); // Existence of main function guaranteed by Resolver
 }
\ No newline at end of file
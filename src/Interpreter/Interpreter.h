@@ -10,15 +10,34 @@
 #include "Interpreter/Environment.h"
 #include "TypeChecker/TypeChecker.h"
 
-class Interpreter {
+// Running value of a `par for ... reduce op`, in the type the TypeChecker gave its body
+struct Reduction {
+    ReduceOp op = ReduceOp::None;
+    bool doubles = false;
+    bool empty = true;
+    int64_t integer = 0;
+    double real = 0;
+
+    void add(const RaftValue&);
+    void add(const Reduction&);
+    RaftValue value() const;
+
+private:
+    void combine(int64_t, double);
+};
+
+class Interpreter : public NativeHost {
 private:
-    std::shared_ptr<Environment> globalEnv;
-    std::shared_ptr<Environment> currentEnv;
+    Environment env;
+    Resolver* resolver; // Only needed to find functions by name for natives
+    bool worker = false; // Runs par for chunks on a pool thread; its calls are left out of traces
 
     const FunctionDecl* mainFn = nullptr;
 
     RaftValue evalBlockExpr(const BlockExpr&);
     RaftValue evaluate(const Expr&);
+    RaftValue evaluateNode(const Expr&);
+    RaftValue evaluateProfiled(const Expr&);
 
     bool isDouble(const RaftValue&);
     bool isString(const RaftValue&);
@@ -26,17 +45,42 @@ private:
 
     double asDouble(const RaftValue&);
 
+    const RaftArray& arrayOperand(const Expr&, const RaftValue& temporary);
+    size_t elementIndex(const RaftArray&, int64_t index, bool checked);
+    const uint8_t* structBytes(const Expr&, RaftValue& temporary);
+
     RaftValue applyBinOp(TokenType, const RaftValue&, const RaftValue&);
     RaftValue applyUnaryOp(TokenType, const RaftValue&);
 
-    RaftValue getAugmentedRHS(TokenType, const RaftValue&);
+    void applyCompoundAssign(const AssignmentStmt&, RaftValue& target, const RaftValue& value);
 
     RaftValue callUserFn(const FunctionDecl*, const std::vector<RaftValue>&);
+    RaftValue callUserFn(const FunctionDecl*, size_t frameBase);
+
+    RaftValue evalParallelFor(const ForExpr&);
+    void runIterations(const ForExpr&, const RaftValue& source, int64_t from, int64_t to, Reduction&);
 
     void execute(const Stmt&);
+    void executeNode(const Stmt&);
+    void executeProfiled(const Stmt&);
     void execute(const std::vector<Stmt>&);
+
+    void runGlobalInitializers(const std::vector<Stmt>&);
     
 public:
-    Interpreter() : globalEnv(std::make_shared<Environment>()), currentEnv(globalEnv) {}
-    void executeProgram(const std::vector<Stmt>&);
+    explicit Interpreter(Resolver* resolver = nullptr);
+    ~Interpreter() override;
+
+    Interpreter(const Interpreter&) = delete;
+    Interpreter& operator=(const Interpreter&) = delete;
+
+    const FunctionInfo& findFunction(const std::string& qualifiedName) override;
+    RaftValue call(const FunctionInfo&, std::vector<RaftValue> args) override;
+
+    void executeProgram(const std::vector<Stmt>&, const ProgramLayout&);
+
+    // Incremental use (REPL): run new global initializers and evaluate input against the live globals
+    void defineGlobals(const std::vector<Stmt>&, const ProgramLayout&);
+    RaftValue evaluateTopLevel(const BlockExpr&, const ProgramLayout&);
+    void reset();
 };
\ No newline at end of file
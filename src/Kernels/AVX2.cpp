@@ -0,0 +1,85 @@
+// Compiled with AVX2 enabled; only called once the CPU has been checked for it. There is no
+// 64-bit integer multiply before AVX-512, so int dot, mul and scale keep the SSE2 (scalar) kernels.
+
+#include <immintrin.h>
+
+#include "Kernels/KernelBodies.h"
+
+namespace {
+    struct DoubleAVX2 {
+        using Vec = __m256d;
+        static constexpr size_t Lanes = 4;
+
+        static Vec zero() { return _mm256_setzero_pd(); }
+        static Vec broadcast(double x) { return _mm256_set1_pd(x); }
+        static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, Vec v) { _mm256_storeu_pd(p, v); }
+
+        static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+        static Vec sqrt(Vec a) { return _mm256_sqrt_pd(a); }
+
+        // Halves are folded down to one lane
+        static double reduceAdd(Vec v) {
+            __m128d x = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+        }
+
+        static double reduceMin(Vec v) {
+            __m128d x = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return _mm_cvtsd_f64(_mm_min_sd(x, _mm_unpackhi_pd(x, x)));
+        }
+
+        static double reduceMax(Vec v) {
+            __m128d x = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+            return _mm_cvtsd_f64(_mm_max_sd(x, _mm_unpackhi_pd(x, x)));
+        }
+    };
+
+    struct IntAVX2 {
+        using Vec = __m256i;
+        static constexpr size_t Lanes = 4;
+
+        static Vec zero() { return _mm256_setzero_si256(); }
+        static Vec broadcast(int64_t x) { return _mm256_set1_epi64x(x); }
+        static Vec load(const int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static void store(int64_t* p, Vec v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+        static Vec add(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+        static Vec max(Vec a, Vec b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+
+        static int64_t reduceAdd(Vec v) {
+            __m128i x = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            return _mm_cvtsi128_si64(_mm_add_epi64(x, _mm_unpackhi_epi64(x, x)));
+        }
+
+        static int64_t reduceMin(Vec v) {
+            alignas(32) int64_t lanes[Lanes];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+
+            int64_t result = lanes[0];
+            for (size_t i = 1; i < Lanes; i++) result = lanes[i] < result ? lanes[i] : result;
+            return result;
+        }
+
+        static int64_t reduceMax(Vec v) {
+            alignas(32) int64_t lanes[Lanes];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+
+            int64_t result = lanes[0];
+            for (size_t i = 1; i < Lanes; i++) result = lanes[i] > result ? lanes[i] : result;
+            return result;
+        }
+    };
+}
+
+void installAVX2Kernels(Kernels& k) {
+    k.level = SimdLevel::AVX2;
+
+    installNumeric<DoubleAVX2>(k.f64);
+    installNumeric<IntAVX2>(k.i64);
+    k.sqrt = &sqrtBody<DoubleAVX2>;
+}
@@ -0,0 +1,55 @@
+// Compiled with AVX-512 F and DQ enabled; only called once the CPU has been checked for both.
+// DQ brings the 64-bit integer multiply, so every kernel but pow is vectorized at this level.
+
+#include <immintrin.h>
+
+#include "Kernels/KernelBodies.h"
+
+namespace {
+    struct DoubleAVX512 {
+        using Vec = __m512d;
+        static constexpr size_t Lanes = 8;
+
+        static Vec zero() { return _mm512_setzero_pd(); }
+        static Vec broadcast(double x) { return _mm512_set1_pd(x); }
+        static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+        static void store(double* p, Vec v) { _mm512_storeu_pd(p, v); }
+
+        static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm512_min_pd(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm512_max_pd(a, b); }
+        static Vec sqrt(Vec a) { return _mm512_sqrt_pd(a); }
+
+        static double reduceAdd(Vec v) { return _mm512_reduce_add_pd(v); }
+        static double reduceMin(Vec v) { return _mm512_reduce_min_pd(v); }
+        static double reduceMax(Vec v) { return _mm512_reduce_max_pd(v); }
+    };
+
+    struct IntAVX512 {
+        using Vec = __m512i;
+        static constexpr size_t Lanes = 8;
+
+        static Vec zero() { return _mm512_setzero_si512(); }
+        static Vec broadcast(int64_t x) { return _mm512_set1_epi64(x); }
+        static Vec load(const int64_t* p) { return _mm512_loadu_si512(p); }
+        static void store(int64_t* p, Vec v) { _mm512_storeu_si512(p, v); }
+
+        static Vec add(Vec a, Vec b) { return _mm512_add_epi64(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm512_mullo_epi64(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm512_min_epi64(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm512_max_epi64(a, b); }
+
+        static int64_t reduceAdd(Vec v) { return _mm512_reduce_add_epi64(v); }
+        static int64_t reduceMin(Vec v) { return _mm512_reduce_min_epi64(v); }
+        static int64_t reduceMax(Vec v) { return _mm512_reduce_max_epi64(v); }
+    };
+}
+
+void installAVX512Kernels(Kernels& k) {
+    k.level = SimdLevel::AVX512;
+
+    installNumeric<DoubleAVX512>(k.f64);
+    installNumeric<IntAVX512>(k.i64);
+    k.sqrt = &sqrtBody<DoubleAVX512>;
+}
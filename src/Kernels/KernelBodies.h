@@ -0,0 +1,142 @@
+#pragma once
+
+// Loop bodies shared by every instruction set. Each Kernels file includes this and instantiates
+// the templates with its own vector traits V:
+//
+//     using Vec = ...;            the register type
+//     Lanes                       elements per register
+//     zero, broadcast, load, store
+//     add, and where the instruction set has them: mul, min, max, sqrt
+//     reduceAdd, reduceMin, reduceMax
+//
+// Everything here has internal linkage. The files are compiled with different instruction set
+// flags, and a shared inline function would let the linker keep an AVX copy for every caller.
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "Kernels/Kernels.h"
+
+namespace {
+    // Integers wrap around like the vector units do, rather than overflowing
+    template<class T> T scalarAdd(T a, T b) {
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+        } else {
+            return a + b;
+        }
+    }
+
+    template<class T> T scalarMul(T a, T b) {
+        if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+        } else {
+            return a * b;
+        }
+    }
+
+    // Four accumulators hide the latency of the adds
+    template<class V, class T> T sumBody(const T* a, size_t n) {
+        typename V::Vec acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(), acc3 = V::zero();
+        size_t i = 0;
+
+        for (; i + 4 * V::Lanes <= n; i += 4 * V::Lanes) {
+            acc0 = V::add(acc0, V::load(a + i));
+            acc1 = V::add(acc1, V::load(a + i + V::Lanes));
+            acc2 = V::add(acc2, V::load(a + i + 2 * V::Lanes));
+            acc3 = V::add(acc3, V::load(a + i + 3 * V::Lanes));
+        }
+
+        for (; i + V::Lanes <= n; i += V::Lanes) acc0 = V::add(acc0, V::load(a + i));
+
+        T total = V::reduceAdd(V::add(V::add(acc0, acc1), V::add(acc2, acc3)));
+        for (; i < n; i++) total = scalarAdd(total, a[i]);
+
+        return total;
+    }
+
+    template<class V, class T> T dotBody(const T* a, const T* b, size_t n) {
+        typename V::Vec acc0 = V::zero(), acc1 = V::zero();
+        size_t i = 0;
+
+        for (; i + 2 * V::Lanes <= n; i += 2 * V::Lanes) {
+            acc0 = V::add(acc0, V::mul(V::load(a + i), V::load(b + i)));
+            acc1 = V::add(acc1, V::mul(V::load(a + i + V::Lanes), V::load(b + i + V::Lanes)));
+        }
+
+        for (; i + V::Lanes <= n; i += V::Lanes) acc0 = V::add(acc0, V::mul(V::load(a + i), V::load(b + i)));
+
+        T total = V::reduceAdd(V::add(acc0, acc1));
+        for (; i < n; i++) total = scalarAdd(total, scalarMul(a[i], b[i]));
+
+        return total;
+    }
+
+    template<class V, class T> T minBody(const T* a, size_t n) {
+        typename V::Vec acc = V::broadcast(a[0]);
+        size_t i = 0;
+
+        for (; i + V::Lanes <= n; i += V::Lanes) acc = V::min(acc, V::load(a + i));
+
+        T result = V::reduceMin(acc);
+        for (; i < n; i++) result = a[i] < result ? a[i] : result;
+
+        return result;
+    }
+
+    template<class V, class T> T maxBody(const T* a, size_t n) {
+        typename V::Vec acc = V::broadcast(a[0]);
+        size_t i = 0;
+
+        for (; i + V::Lanes <= n; i += V::Lanes) acc = V::max(acc, V::load(a + i));
+
+        T result = V::reduceMax(acc);
+        for (; i < n; i++) result = a[i] > result ? a[i] : result;
+
+        return result;
+    }
+
+    template<class V, class T> void addBody(const T* a, const T* b, T* out, size_t n) {
+        size_t i = 0;
+        for (; i + V::Lanes <= n; i += V::Lanes) V::store(out + i, V::add(V::load(a + i), V::load(b + i)));
+        for (; i < n; i++) out[i] = scalarAdd(a[i], b[i]);
+    }
+
+    template<class V, class T> void mulBody(const T* a, const T* b, T* out, size_t n) {
+        size_t i = 0;
+        for (; i + V::Lanes <= n; i += V::Lanes) V::store(out + i, V::mul(V::load(a + i), V::load(b + i)));
+        for (; i < n; i++) out[i] = scalarMul(a[i], b[i]);
+    }
+
+    template<class V, class T> void scaleBody(const T* a, T factor, T* out, size_t n) {
+        typename V::Vec k = V::broadcast(factor);
+        size_t i = 0;
+
+        for (; i + V::Lanes <= n; i += V::Lanes) V::store(out + i, V::mul(V::load(a + i), k));
+        for (; i < n; i++) out[i] = scalarMul(a[i], factor);
+    }
+
+    template<class V> void sqrtBody(const double* a, double* out, size_t n) {
+        size_t i = 0;
+        for (; i + V::Lanes <= n; i += V::Lanes) V::store(out + i, V::sqrt(V::load(a + i)));
+        for (; i < n; i++) out[i] = __builtin_sqrt(a[i]);
+    }
+
+    // Fills in the kernels V has the operations for
+    template<class V, class T> void installNumeric(NumericKernels<T>& k) {
+        k.sum = &sumBody<V, T>;
+        k.add = &addBody<V, T>;
+
+        if constexpr (requires { V::mul; }) {
+            k.dot = &dotBody<V, T>;
+            k.mul = &mulBody<V, T>;
+            k.scale = &scaleBody<V, T>;
+        }
+
+        if constexpr (requires { V::min; V::max; }) {
+            k.min = &minBody<V, T>;
+            k.max = &maxBody<V, T>;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+
+#include "Kernels/Kernels.h"
+#include "Kernels/KernelBodies.h"
+
+namespace {
+    // One element per "register": the portable fallback every other level starts from
+    template<class T>
+    struct ScalarTraits {
+        using Vec = T;
+        static constexpr size_t Lanes = 1;
+
+        static Vec zero() { return T(0); }
+        static Vec broadcast(T x) { return x; }
+        static Vec load(const T* p) { return *p; }
+        static void store(T* p, Vec v) { *p = v; }
+
+        static Vec add(Vec a, Vec b) { return scalarAdd(a, b); }
+        static Vec mul(Vec a, Vec b) { return scalarMul(a, b); }
+        static Vec min(Vec a, Vec b) { return b < a ? b : a; }
+        static Vec max(Vec a, Vec b) { return b > a ? b : a; }
+        static Vec sqrt(Vec a) { return std::sqrt(a); }
+
+        static T reduceAdd(Vec v) { return v; }
+        static T reduceMin(Vec v) { return v; }
+        static T reduceMax(Vec v) { return v; }
+    };
+
+    // No instruction set has a vector pow, so every level uses this one
+    void powScalar(const double* a, double exponent, double* out, size_t n) {
+        for (size_t i = 0; i < n; i++) out[i] = std::pow(a[i], exponent);
+    }
+
+    Kernels scalarKernels() {
+        Kernels k{};
+        k.level = SimdLevel::Scalar;
+
+        installNumeric<ScalarTraits<double>>(k.f64);
+        installNumeric<ScalarTraits<int64_t>>(k.i64);
+        k.sqrt = &sqrtBody<ScalarTraits<double>>;
+        k.pow = &powScalar;
+
+        return k;
+    }
+
+    SimdLevel hardwareLevel() {
+#if defined(RAFT_X86_KERNELS) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        return SimdLevel::SSE2;
+#elif defined(RAFT_X86_KERNELS)
+        return SimdLevel::SSE2; // Part of x86-64 itself
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE2: return "sse2";
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+
+    return "unknown";
+}
+
+SimdLevel detectSimdLevel() {
+    SimdLevel level = hardwareLevel();
+
+    if (const char* requested = std::getenv("RAFT_SIMD")) {
+        for (auto lower : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+            if (std::string(requested) == simdLevelName(lower) && lower < level) level = lower;
+        }
+    }
+
+    return level;
+}
+
+const Kernels& kernelsFor(SimdLevel level) {
+    static const Kernels tables[] = {
+        [] { return scalarKernels(); }(),
+#ifdef RAFT_X86_KERNELS
+        [] { Kernels k = scalarKernels(); installSSE2Kernels(k); return k; }(),
+        [] { Kernels k = scalarKernels(); installSSE2Kernels(k); installAVX2Kernels(k); return k; }(),
+        [] { Kernels k = scalarKernels(); installSSE2Kernels(k); installAVX2Kernels(k); installAVX512Kernels(k); return k; }(),
+#endif
+    };
+
+    size_t index = std::min(static_cast<size_t>(level), std::size(tables) - 1);
+    return tables[index];
+}
+
+const Kernels& kernels() {
+    static const Kernels& selected = kernelsFor(detectSimdLevel());
+    return selected;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized loops over contiguous arrays, behind std.math's array functions. Every instruction
+// set has its own table of kernels, compiled for it in its own file (SSE2.cpp, AVX2.cpp,
+// AVX512.cpp); kernels() picks the best one the CPU supports the first time it is called.
+
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+template<class T>
+struct NumericKernels {
+    T (*sum)(const T*, size_t);
+    T (*dot)(const T*, const T*, size_t);
+    T (*min)(const T*, size_t); // n must be at least 1
+    T (*max)(const T*, size_t);
+
+    void (*add)(const T*, const T*, T*, size_t);
+    void (*mul)(const T*, const T*, T*, size_t);
+    void (*scale)(const T*, T, T*, size_t);
+};
+
+struct Kernels {
+    SimdLevel level;
+
+    NumericKernels<double> f64;
+    NumericKernels<int64_t> i64; // Integer arithmetic wraps around, as it does in the vector units
+
+    void (*sqrt)(const double*, double*, size_t);
+    void (*pow)(const double*, double, double*, size_t);
+};
+
+const char* simdLevelName(SimdLevel);
+
+// Best level the CPU supports, lowered by the RAFT_SIMD environment variable (scalar, sse2, avx2, avx512)
+SimdLevel detectSimdLevel();
+
+// Kernels of the given level; levels the build doesn't have fall back to the next one down
+const Kernels& kernelsFor(SimdLevel);
+
+// Kernels for the detected level
+const Kernels& kernels();
+
+// Each instruction set's file fills in what it accelerates, keeping the entries of the level below
+void installSSE2Kernels(Kernels&);
+void installAVX2Kernels(Kernels&);
+void installAVX512Kernels(Kernels&);
@@ -0,0 +1,50 @@
+// Compiled for SSE2, which every x86-64 CPU has. SSE2 has no 64-bit integer multiply, min or
+// max, so those int kernels stay scalar.
+
+#include <emmintrin.h>
+
+#include "Kernels/KernelBodies.h"
+
+namespace {
+    struct DoubleSSE2 {
+        using Vec = __m128d;
+        static constexpr size_t Lanes = 2;
+
+        static Vec zero() { return _mm_setzero_pd(); }
+        static Vec broadcast(double x) { return _mm_set1_pd(x); }
+        static Vec load(const double* p) { return _mm_loadu_pd(p); }
+        static void store(double* p, Vec v) { _mm_storeu_pd(p, v); }
+
+        static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+        static Vec sqrt(Vec a) { return _mm_sqrt_pd(a); }
+
+        static double reduceAdd(Vec v) { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+        static double reduceMin(Vec v) { return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v))); }
+        static double reduceMax(Vec v) { return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v))); }
+    };
+
+    struct IntSSE2 {
+        using Vec = __m128i;
+        static constexpr size_t Lanes = 2;
+
+        static Vec zero() { return _mm_setzero_si128(); }
+        static Vec broadcast(int64_t x) { return _mm_set1_epi64x(x); }
+        static Vec load(const int64_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        static void store(int64_t* p, Vec v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+        static Vec add(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+
+        static int64_t reduceAdd(Vec v) { return _mm_cvtsi128_si64(_mm_add_epi64(v, _mm_unpackhi_epi64(v, v))); }
+    };
+}
+
+void installSSE2Kernels(Kernels& k) {
+    k.level = SimdLevel::SSE2;
+
+    installNumeric<DoubleSSE2>(k.f64);
+    installNumeric<IntSSE2>(k.i64);
+    k.sqrt = &sqrtBody<DoubleSSE2>;
+}
@@ -16,11 +16,11 @@ void Lexer::Error(LexerError err) {
 
     switch (err) {
         case LexerError::InvalidToken:
-            std::cout << "[Error] Invalid Token\n";
+            std::cout << "[Error] Invalid Token at " << line << ":" << tokenStart - lineStart + 1 << "\n";
             break;
             
         case LexerError::UnendingString:
-            std::cout << "[Error] Unterminating String\n";
+            std::cout << "[Error] Unterminating String at " << line << ":" << tokenStart - lineStart + 1 << "\n";
             break;
         
         default:
@@ -84,7 +84,9 @@ TokenType isKeywOrIden(const std::string& id) {
         {"else", TokenType::ELSE},
         {"while", TokenType::WHILE},
         {"for", TokenType::FOR},
+        {"in", TokenType::IN},
         {"loop", TokenType::LOOP},
+        {"struct", TokenType::STRUCT},
         {"fn", TokenType::FN},
         {"break", TokenType::BREAK},
         {"continue", TokenType::CONTINUE},
@@ -173,6 +175,7 @@ std::string Lexer::getIdentifier() {
 
 void Lexer::addToken(TokenType type, RaftValue value = std::monostate{}) {
     tokens.push_back(Token(type, value, line));
+    tokens.back().column = static_cast<uint32_t>(tokenStart - lineStart + 1);
 }
 
 std::vector<Token> Lexer::scanTokens(const std::string& str) {
@@ -181,6 +184,7 @@ std::vector<Token> Lexer::scanTokens(const std::string& str) {
     while (!isAtEnd(index)) {
         if (hasError) break;
 
+        tokenStart = index;
         char c = getChar();
 
         switch (c) {
@@ -191,14 +195,17 @@ std::vector<Token> Lexer::scanTokens(const std::string& str) {
 
             case '\n':
                 line++;
+                lineStart = index + 1;
                 break;
 
             case '(': addToken(TokenType::LEFT_PAREN); break;
             case ')': addToken(TokenType::RIGHT_PAREN); break;
             case '{': addToken(TokenType::LEFT_BRACE); break;
             case '}': addToken(TokenType::RIGHT_BRACE); break;
+            case '[': addToken(TokenType::LEFT_BRACKET); break;
+            case ']': addToken(TokenType::RIGHT_BRACKET); break;
             case ',': addToken(TokenType::COMMA); break;
-            case '.': addToken(TokenType::DOT); break;
+            case '.': addToken(match('.')? TokenType::DOT_DOT : TokenType::DOT); break;
             case ';': addToken(TokenType::SEMICOLON); break;
 
             case '+': 
@@ -240,7 +247,7 @@ std::vector<Token> Lexer::scanTokens(const std::string& str) {
                     while (peek() != '\n' && !isAtEnd(index)) advance();
                 }
                 else {
-                    addToken(TokenType::DIV);
+                    addToken(match('=')? TokenType::DIV_EQUAL : TokenType::DIV);
                 }
                 break;
 
@@ -282,7 +289,8 @@ std::vector<Token> Lexer::scanTokens(const std::string& str) {
                     }
 
                     if (type == TokenType::IDENTIFIER) {
-                        addToken(TokenType::IDENTIFIER, id);
+                        addToken(TokenType::IDENTIFIER);
+                        tokens.back().symbol = intern(id);
                         break;
                     }
 
@@ -18,6 +18,8 @@ class Lexer {
     std::vector<Token> tokens;
     size_t index = 0;
     size_t line = 1;
+    size_t lineStart = 0;  // Index of the first character of the current line
+    size_t tokenStart = 0; // Index of the first character of the token being scanned
 
     bool hasError = false;
 
@@ -0,0 +1,170 @@
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <pthread.h>
+#define RAFT_HAS_SIGPROF 1
+#endif
+
+#include "Parallel/WorkPool.h"
+
+namespace {
+    // Set on pool threads, and on a caller while it runs a job
+    thread_local bool insideJob = false;
+}
+
+WorkPool::WorkPool(size_t count) {
+    count = std::max<size_t>(count, 1);
+    for (size_t i = 0; i < count; i++) queues.push_back(std::make_unique<Queue>());
+
+    for (size_t worker = 1; worker < count; worker++) threads.emplace_back(&WorkPool::workerMain, this, worker);
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+
+    wake.notify_all();
+    for (auto& thread : threads) thread.join();
+}
+
+WorkPool& WorkPool::global() {
+    static WorkPool pool([] {
+        if (const char* threads = std::getenv("RAFT_THREADS")) {
+            long count = std::strtol(threads, nullptr, 10);
+            if (count > 0) return static_cast<size_t>(count);
+        }
+
+        return static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+    }());
+
+    return pool;
+}
+
+void WorkPool::run(size_t chunks, const Task& job) {
+    if (chunks == 0) return;
+
+    if (insideJob || queues.size() == 1) {
+        for (size_t chunk = 0; chunk < chunks; chunk++) job(chunk, 0);
+        return;
+    }
+
+    // Thread t starts with chunks [t * chunks / n, (t + 1) * chunks / n)
+    size_t n = queues.size();
+    for (size_t t = 0; t < n; t++) {
+        std::lock_guard<std::mutex> guard(queues[t]->lock);
+        queues[t]->next = t * chunks / n;
+        queues[t]->end = (t + 1) * chunks / n;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        task = &job;
+        failed = false;
+        error = nullptr;
+        busy = threads.size();
+        generation++;
+    }
+
+    wake.notify_all();
+
+    insideJob = true;
+    work(0);
+    insideJob = false;
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [&] { return busy == 0; });
+    task = nullptr;
+
+    if (error) std::rethrow_exception(error);
+}
+
+void WorkPool::workerMain(size_t worker) {
+#ifdef RAFT_HAS_SIGPROF
+    // Profiler samples read the shadow stack of the thread they land on; only the main one keeps it
+    sigset_t profiling;
+    sigemptyset(&profiling);
+    sigaddset(&profiling, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &profiling, nullptr);
+#endif
+
+    insideJob = true;
+    uint64_t seen = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+
+            seen = generation;
+        }
+
+        work(worker);
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--busy == 0) done.notify_one();
+    }
+}
+
+void WorkPool::work(size_t worker) {
+    size_t chunk;
+
+    while (take(worker, chunk) || (steal(worker) && take(worker, chunk))) {
+        if (failed) continue; // Drain the queues without running anything
+
+        try {
+            (*task)(chunk, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    }
+}
+
+bool WorkPool::take(size_t worker, size_t& chunk) {
+    Queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.next == queue.end) return false;
+
+    chunk = queue.next++;
+    return true;
+}
+
+// Moves the back half of the fullest other queue into this thread's (empty) queue
+bool WorkPool::steal(size_t worker) {
+    for (;;) {
+        size_t victim = worker;
+        size_t most = 0;
+
+        for (size_t t = 0; t < queues.size(); t++) {
+            if (t == worker) continue;
+
+            std::lock_guard<std::mutex> guard(queues[t]->lock);
+            size_t left = queues[t]->end - queues[t]->next;
+            if (left > most) { most = left; victim = t; }
+        }
+
+        if (victim == worker) return false;
+
+        size_t from, to;
+        {
+            std::lock_guard<std::mutex> guard(queues[victim]->lock);
+            size_t left = queues[victim]->end - queues[victim]->next;
+            if (left == 0) continue; // Emptied since it was looked at
+
+            to = queues[victim]->end;
+            from = to - (left + 1) / 2;
+            queues[victim]->end = from;
+        }
+
+        std::lock_guard<std::mutex> guard(queues[worker]->lock);
+        queues[worker]->next = from;
+        queues[worker]->end = to;
+        return true;
+    }
+}
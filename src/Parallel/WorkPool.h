@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads that run the chunks of par for loops. A job's chunks are dealt out to the threads in
+// contiguous ranges; a thread that runs out of its own steals the back half of another's range,
+// so uneven iterations still keep every thread busy. The thread that starts a job runs chunks too.
+class WorkPool {
+public:
+    using Task = std::function<void(size_t chunk, size_t worker)>;
+
+    explicit WorkPool(size_t threads);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    // Threads a job runs on, the calling one included
+    size_t size() const { return queues.size(); }
+
+    // Runs task for every chunk in [0, chunks) and returns once all have finished. Worker 0 is the
+    // calling thread. After a task throws no further chunks are started, and the first exception is
+    // rethrown here. A job started from inside another job runs on the calling thread alone.
+    void run(size_t chunks, const Task& task);
+
+    // Sized by RAFT_THREADS, or the number of hardware threads; started on first use
+    static WorkPool& global();
+
+private:
+    // The chunks a thread has left: it takes from the front, thieves take from the back
+    struct Queue {
+        std::mutex lock;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0; // Bumped for every job so sleeping threads know there is work
+    size_t busy = 0;         // Threads that have yet to finish the current job
+    bool stopping = false;
+
+    const Task* task = nullptr;
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+
+    void workerMain(size_t worker);
+    void work(size_t worker);
+    bool take(size_t worker, size_t& chunk);
+    bool steal(size_t worker);
+};
@@ -6,8 +6,13 @@
 #include "AST/AST.h"
 #include "Parser/parser.h"
 
-Parser::Parser(const std::vector<Token>& tokens)
-: tokens(tokens) {}
+Parser::Parser(const std::vector<Token>& tokens, uint32_t file)
+: tokens(tokens), file(file) {}
+
+// Records where a node starts in the source map
+SourcePos Parser::at(const Token& tok) {
+    return sourcePosition(file, tok.line, tok.column);
+}
 
 // matchs if current token is EOF
 bool Parser::isAtEnd() {
@@ -91,17 +96,44 @@ bool Parser::match_peek(TokenType type) {
     return (peek_type == type);
 }
 
+// A type name such as int, int[] for an array of it, or Map<string, int>
+std::string Parser::parseTypeName() {
+    std::string name = symbolName(expect(TokenType::IDENTIFIER, "Expected a type").symbol);
+
+    if (name == "Map" && match(TokenType::LESS)) {
+        consume();
+        std::string key = parseTypeName();
+        expect(TokenType::COMMA, "Expected ',' between the key and value types");
+        std::string value = parseTypeName();
+
+        // In `let m: Map<string, int>= ...` the lexer reads the end as >=
+        if (match(TokenType::GREATER_EQUAL)) tokens[index].type = TokenType::EQUAL;
+        else expect(TokenType::GREATER, "Expected '>' after the value type");
+
+        name = "Map<" + key + ", " + value + ">";
+    }
+
+    if (match(TokenType::LEFT_BRACKET)) {
+        consume();
+        expect(TokenType::RIGHT_BRACKET, "Expected ']' in array type");
+        name += "[]";
+    }
+
+    return name;
+}
+
 Expr Parser::parseLogic() {
     Expr left = parseComparison();
 
     while (match({ TokenType::LOG_AND, TokenType::LOG_OR })) {
-        auto op = consume().type;
+        Token opToken = consume();
 
         Expr right = parseComparison();
         left = std::make_unique<BinaryExpr>(
-            op,
+            opToken.type,
             std::move(left),
-            std::move(right)
+            std::move(right),
+            at(opToken)
         );
     }
 
@@ -121,13 +153,14 @@ Expr Parser::parseComparison() {
             TokenType::NOT_EQUAL
         }
     )) {
-        auto op = consume().type;
+        Token opToken = consume();
 
         Expr right = parseExpression();
         left = std::make_unique<BinaryExpr>(
-            op,
+            opToken.type,
             std::move(left),
-            std::move(right)
+            std::move(right),
+            at(opToken)
         );
     }
 
@@ -138,13 +171,14 @@ Expr Parser::parseExpression() {
     Expr left = parseTerm();
 
     while (match({TokenType::PLUS, TokenType::MINUS})) {
-        auto op = consume().type;
+        Token opToken = consume();
 
         Expr right = parseTerm();
         left = std::make_unique<BinaryExpr>(
-            op,
+            opToken.type,
             std::move(left),
-            std::move(right)
+            std::move(right),
+            at(opToken)
         );
     }
     return left;
@@ -154,13 +188,14 @@ Expr Parser::parseTerm() {
     Expr left = parseUnary();
 
     while (match({TokenType::MUL, TokenType::DIV})) {
-        auto op = consume().type;
+        Token opToken = consume();
 
         Expr right = parseUnary();
         left = std::make_unique<BinaryExpr>(
-            op,
+            opToken.type,
             std::move(left),
-            std::move(right)
+            std::move(right),
+            at(opToken)
         );
     }
 
@@ -169,17 +204,120 @@ Expr Parser::parseTerm() {
 
 Expr Parser::parseUnary() {
     while (match({TokenType::MINUS, TokenType::NOT})) {
-        auto op = consume().type;
+        Token opToken = consume();
 
-        Expr right = parsePrimary();
+        Expr right = parsePostfix();
 
         return std::make_unique<UnaryExpr>(
-            op,
-            std::move(right)
+            opToken.type,
+            std::move(right),
+            at(opToken)
         );
     }
 
-    return parsePrimary();
+    return parsePostfix();
+}
+
+// Indexing and fields: a[i], a[i][j], a[i].x, f().x
+Expr Parser::parsePostfix() {
+    Expr expr = parsePrimary();
+
+    // `if`, `while` and blocks end a statement, so a following '[' starts the next one
+    if (isBlockLike(expr)) return expr;
+
+    while (match({TokenType::LEFT_BRACKET, TokenType::DOT})) {
+        if (match(TokenType::DOT)) {
+            consume();
+            Token field = expect(TokenType::IDENTIFIER, "Expected a field name after '.'");
+
+            expr = std::make_unique<FieldExpr>(FieldExpr{ std::move(expr), field.symbol, nullptr, at(field) });
+            continue;
+        }
+
+        Token bracket = consume();
+
+        Expr index = parseLogic();
+        expect(TokenType::RIGHT_BRACKET, "Expected ']' after index");
+
+        expr = std::make_unique<IndexExpr>(IndexExpr{ std::move(expr), std::move(index), true, at(bracket) });
+    }
+
+    return expr;
+}
+
+// [a, b, c] or [fill; count]
+Expr Parser::parseArrayExpr() {
+    Token bracket = consume();
+
+    auto array = std::make_unique<ArrayExpr>();
+    array->pos = at(bracket);
+
+    if (match(TokenType::RIGHT_BRACKET)) throw ParseError("An empty array needs an element type, e.g. [0; 0]");
+
+    array->elements.push_back(parseLogic());
+
+    if (match(TokenType::SEMICOLON)) {
+        consume();
+        array->count = std::make_unique<Expr>(parseLogic());
+    } else {
+        while (match(TokenType::COMMA)) {
+            consume();
+            if (match(TokenType::RIGHT_BRACKET)) break; // Trailing comma
+
+            array->elements.push_back(parseLogic());
+        }
+    }
+
+    expect(TokenType::RIGHT_BRACKET, "Expected ']' after array elements");
+
+    return array;
+}
+
+// Point { x: 1.0, y: 2.0 }
+Expr Parser::parseStructExpr() {
+    Token name = consume();
+    consume(); // Consume {
+
+    auto literal = std::make_unique<StructExpr>();
+    literal->name = name.symbol;
+    literal->pos = at(name);
+
+    while (!match(TokenType::RIGHT_BRACE)) {
+        Token field = expect(TokenType::IDENTIFIER, "Expected a field name");
+        expect(TokenType::COLON, "Expected ':' after the field name");
+
+        literal->fields.push_back(StructExpr::Field{ field.symbol, parseLogic() });
+
+        if (!match(TokenType::COMMA)) break;
+        consume();
+    }
+
+    expect(TokenType::RIGHT_BRACE, "Expected '}' after the fields");
+
+    return literal;
+}
+
+// Map<string, int> { "one": 1, "two": 2 }
+Expr Parser::parseMapExpr() {
+    auto literal = std::make_unique<MapExpr>();
+    literal->pos = at(current());
+    literal->type = parseTypeName();
+
+    expect(TokenType::LEFT_BRACE, "Expected '{' after the map type");
+
+    while (!match(TokenType::RIGHT_BRACE)) {
+        Expr key = parseLogic();
+        expect(TokenType::COLON, "Expected ':' after the key");
+
+        literal->entries.push_back(MapExpr::Entry{ std::move(key), parseLogic() });
+
+        if (!match(TokenType::COMMA)) break;
+        consume();
+    }
+
+    expect(TokenType::RIGHT_BRACE, "Expected '}' after the entries");
+
+    return literal;
 }
 
 Expr Parser::parsePrimary() {
@@ -195,6 +333,19 @@ Expr Parser::parsePrimary() {
         return parseWhileExpr();
     }
 
+    // `par` is only a keyword in front of `for`, so it stays usable as a name (std.par)
+    if (match(TokenType::FOR) || (match(TokenType::IDENTIFIER) && match_peek(TokenType::FOR) && symbolName(current().symbol) == "par")) {
+        return parseForExpr();
+    }
+
+    if (match(TokenType::LOOP)) {
+        return parseLoopExpr();
+    }
+
+    if (match(TokenType::LEFT_BRACKET)) {
+        return parseArrayExpr();
+    }
+
     if (match(TokenType::DOUBLE)) {
         Token tok = consume();
         return LiteralExpr{ std::get<double>(tok.value) };
@@ -215,14 +366,27 @@ Expr Parser::parsePrimary() {
         return LiteralExpr{ std::get<bool>(tok.value) };
     }
 
+    // Name { field: ... }; a block can't start with `field:`, so this is never an identifier followed by a block
+    if (match(TokenType::IDENTIFIER) && match_peek(TokenType::LESS) && symbolName(current().symbol) == "Map") {
+        return parseMapExpr();
+    }
+
+    if (match(TokenType::IDENTIFIER) && match_peek(TokenType::LEFT_BRACE) && index + 3 < tokens.size()
+        && tokens[index + 2].type == TokenType::IDENTIFIER && tokens[index + 3].type == TokenType::COLON) {
+        return parseStructExpr();
+    }
+
     if (match(TokenType::IDENTIFIER)) {
-        std::vector<std::string> name_parts;
-        name_parts.push_back(std::get<std::string>(consume().value));
+        Token first = consume();
+        std::vector<Symbol> name_parts;
+        std::vector<Token> parts = { first };
+        name_parts.push_back(first.symbol);
 
         while (match(TokenType::DOT)) {
             consume();
             auto tok = expect(TokenType::IDENTIFIER, "Expected identifier after dot");
-            name_parts.push_back(std::get<std::string>(tok.value));
+            name_parts.push_back(tok.symbol);
+            parts.push_back(tok);
         }
 
         if (match(TokenType::LEFT_PAREN)) {
@@ -242,11 +406,16 @@ Expr Parser::parsePrimary() {
 
             expect(TokenType::RIGHT_PAREN, "Expected ')' after parameters");
 
-            return std::make_unique<CallExpr> ( name_parts, std::move(args) );
+            return std::make_unique<CallExpr> ( name_parts, std::move(args), nullptr, at(first) );
         }
 
-        if (name_parts.size() > 1) throw ParseError("Modules do not (yet) support variables");
-        return VariableExpr{ name_parts[0] };
+        // Without a call, the parts after the first are fields: p.position.x
+        Expr expr = VariableExpr{ name_parts[0], {}, at(first) };
+        for (size_t i = 1; i < parts.size(); i++) {
+            expr = std::make_unique<FieldExpr>(FieldExpr{ std::move(expr), parts[i].symbol, nullptr, at(parts[i]) });
+        }
+
+        return expr;
     }
     
     if (match(TokenType::LEFT_PAREN)) {
@@ -261,7 +430,7 @@ Expr Parser::parsePrimary() {
 
 Stmt Parser::parseLetStmt() {
     bool mut = false;
-    consume(); // Consumes the let keyword
+    Token let = consume(); // Consumes the let keyword
 
     if (match({TokenType::VAR})) {
         mut = true;
@@ -272,15 +441,13 @@ Stmt Parser::parseLetStmt() {
 
     std::string annotated_type = "";
     if (match(TokenType::IDENTIFIER)) {
-        auto annotation = consume();
-
-        annotated_type = std::get<std::string>(annotation.value);
+        annotated_type = parseTypeName();
     }
 
     if (!match({TokenType::EQUAL})) {
         expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-        return VarDeclStmt {std::get<std::string>(id.value), mut, LiteralExpr {std::monostate()}};
+        return VarDeclStmt {id.symbol, mut, LiteralExpr {std::monostate()}, "", {}, at(let)};
     }
 
     consume(); // Consumes the equal
@@ -289,19 +456,61 @@ Stmt Parser::parseLetStmt() {
 
     expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-    return VarDeclStmt{ std::get<std::string>(id.value), mut, std::move(expr), annotated_type };
+    return VarDeclStmt{ id.symbol, mut, std::move(expr), annotated_type, {}, at(let) };
+}
+
+// A name followed by = or a compound assignment operator
+bool Parser::isAssignment() {
+    return match(TokenType::IDENTIFIER) && match_peek({
+        TokenType::EQUAL, TokenType::PLUS_EQUAL, TokenType::MINUS_EQUAL, TokenType::MUL_EQUAL, TokenType::DIV_EQUAL,
+        TokenType::PLUS_PLUS, TokenType::MINUS_MINUS
+    });
 }
 
 Stmt Parser::parseAssignment() {
     Token id = consume();
 
-    auto op = consume().type; // Consumes the equal
+    auto op = consume().type; // Consumes the operator
 
-    Expr expr = parseLogic();
+    // x++ and x-- are x += 1 and x -= 1
+    Expr expr = op == TokenType::PLUS_PLUS || op == TokenType::MINUS_MINUS ? Expr(LiteralExpr{ int64_t{1} }) : parseLogic();
 
     expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-    return AssignmentStmt { std::get<std::string>(id.value), std::move(expr), op};
+    return AssignmentStmt { id.symbol, std::move(expr), op, {}, at(id) };
+}
+
+// target is the already parsed left hand side: an element of an array variable, or a field of a
+// struct variable or of an element of a struct array variable
+Stmt Parser::parseIndexAssignment(Expr target) {
+    std::vector<Symbol> fields;
+    SourcePos fieldPos = 0;
+
+    Expr* base = &target;
+    while (auto* field = std::get_if<std::unique_ptr<FieldExpr>>(base)) {
+        fields.insert(fields.begin(), (*field)->field);
+        fieldPos = (*field)->pos;
+        base = &(*field)->object;
+    }
+
+    auto* element = std::get_if<std::unique_ptr<IndexExpr>>(base);
+    auto* variable = std::get_if<VariableExpr>(element ? &(*element)->array : base);
+
+    if (!variable || (!element && fields.empty()))
+        throw ParseError("Only variables, elements of array variables and their fields can be assigned to");
+
+    consume(); // Consumes the equal
+
+    Expr value = parseLogic();
+
+    expect(TokenType::SEMICOLON, "Expected a semi-colon");
+
+    if (fields.empty()) {
+        return IndexAssignStmt { variable->id, std::move((*element)->index), std::move(value), {}, true, (*element)->pos };
+    }
+
+    std::unique_ptr<Expr> index = element ? std::make_unique<Expr>(std::move((*element)->index)) : nullptr;
+    return FieldAssignStmt { variable->id, std::move(index), std::move(fields), std::move(value), {}, 0, nullptr, true, fieldPos };
 }
 
 Stmt Parser::parseStmt() {
@@ -321,73 +530,118 @@ Stmt Parser::parseStmt() {
         return parseFnDecl();
     }
 
+    if (match(TokenType::STRUCT)) {
+        return parseStructDecl();
+    }
+
     if (match(TokenType::BREAK)) {
-        consume();
+        Token keyword = consume();
 
         expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-        return BreakStmt {};
+        return BreakStmt { at(keyword) };
     }
 
     if (match(TokenType::CONTINUE)) {
-        consume();
+        Token keyword = consume();
 
         expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-        return ContinueStmt {};
+        return ContinueStmt { at(keyword) };
     }
 
     if (match(TokenType::RETURN)) {
-        consume();
+        Token keyword = consume();
 
         auto expr = parseLogic();
 
         expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
-        return ReturnStmt { std::move(expr) };
+        return ReturnStmt { std::move(expr), at(keyword) };
     }
     
-    if (match(TokenType::IDENTIFIER) && match_peek(TokenType::EQUAL)) {
+    if (isAssignment()) {
         return parseAssignment();
     }
 
     auto expr = parseLogic();
 
+    if (match(TokenType::EQUAL)) return parseIndexAssignment(std::move(expr));
+
     expect(TokenType::SEMICOLON, "Expected a semi-colon");
 
     return ExprStmt{ std::move(expr) };
 }
 
+bool Parser::isBlockLike(const Expr& expr) {
+    return std::holds_alternative<std::unique_ptr<IfExpr>>(expr)
+        || std::holds_alternative<std::unique_ptr<WhileExpr>>(expr)
+        || std::holds_alternative<std::unique_ptr<ForExpr>>(expr)
+        || std::holds_alternative<std::unique_ptr<LoopExpr>>(expr)
+        || std::holds_alternative<std::unique_ptr<BlockExpr>>(expr);
+}
+
 Expr Parser::parseBlockExpr() {
     expect(TokenType::LEFT_BRACE, "Expected '{'");
+    auto block = parseBlockBody(true);
+    expect(TokenType::RIGHT_BRACE, "Expected '}'");
+
+    return block;
+}
+
+std::unique_ptr<BlockExpr> Parser::parseBlockContents() {
+    try {
+        auto block = parseBlockBody(false);
+        if (!isAtEnd()) throw ParseError("Unexpected '}'");
+
+        return block;
+    } catch (const ParseError&) {
+        rethrowAt(at(current()));
+    }
+}
+
+// Statements up to the closing brace (or the end of input when there are no braces)
+std::unique_ptr<BlockExpr> Parser::parseBlockBody(bool braced) {
     std::vector<Stmt> statements;
     std::optional<std::unique_ptr<Expr>> tail = std::nullopt;
 
     while (!match(TokenType::RIGHT_BRACE) && !isAtEnd()) {
-        if (match({TokenType::LET, TokenType::RETURN, TokenType::CONTINUE, TokenType::IMPORT})) {
+        if (match({TokenType::LET, TokenType::RETURN, TokenType::BREAK, TokenType::CONTINUE, TokenType::IMPORT})) {
             statements.push_back(parseStmt());
             continue;
         }
 
+        if (isAssignment()) {
+            statements.push_back(parseAssignment());
+            continue;
+        }
+
         Expr expr = parseLogic();
 
+        if (match(TokenType::EQUAL)) {
+            statements.push_back(parseIndexAssignment(std::move(expr)));
+            continue;
+        }
+
         if (match(TokenType::SEMICOLON)) {
             consume();
             statements.push_back(ExprStmt{ std::move(expr) });
-        } else if (match(TokenType::RIGHT_BRACE)) {
+        } else if (braced ? match(TokenType::RIGHT_BRACE) : isAtEnd()) {
             tail = std::make_unique<Expr>(std::move(expr));
             break;
+        } else if (isBlockLike(expr)) {
+            // if, while and blocks can be used as statements without a trailing ';'
+            statements.push_back(ExprStmt{ std::move(expr) });
         } else {
             throw ParseError("Expected ';' after expression");
         }
     }
 
-    expect(TokenType::RIGHT_BRACE, "Expected '}'");
     return std::make_unique<BlockExpr>(BlockExpr{ std::move(statements), std::move(tail) });
 }
 
 Expr Parser::parseIfExpr() {
-    consume();
+    Token keyword = consume();
 
     Expr cond = parseLogic();
 
@@ -410,25 +664,73 @@ Expr Parser::parseIfExpr() {
         throw ParseError("'if' used as an expression requires an 'else' branch");
     }
 
-    return std::make_unique<IfExpr>(IfExpr{std::move(cond), std::move(thenBranch), std::move(elseBranch)
+    return std::make_unique<IfExpr>(IfExpr{std::move(cond), std::move(thenBranch), std::move(elseBranch), at(keyword)
     });
 }
 
 Expr Parser::parseWhileExpr() {
-    consume(); // Consume while
+    Token keyword = consume(); // Consume while
     
     auto expr = parseLogic();
     auto body = std::get<std::unique_ptr<BlockExpr>>(parseBlockExpr());
 
-    return std::make_unique<WhileExpr>( std::move(expr), std::move(body) );
+    return std::make_unique<WhileExpr>( std::move(expr), std::move(body), at(keyword) );
+}
+
+// for i in a..b { }, for x in array { }, and par for with an optional `reduce op` before the body
+Expr Parser::parseForExpr() {
+    Token keyword = consume(); // Consume for or par
+
+    bool parallel = keyword.type == TokenType::IDENTIFIER;
+    if (parallel) consume(); // Consume for
+
+    Token name = expect(TokenType::IDENTIFIER, "Expected a loop variable after 'for'");
+    expect(TokenType::IN, "Expected 'in' after the loop variable");
+
+    Expr start = parseExpression();
+
+    std::unique_ptr<Expr> end;
+    if (match(TokenType::DOT_DOT)) {
+        consume();
+        end = std::make_unique<Expr>(parseExpression());
+    }
+
+    // Likewise `reduce`
+    ReduceOp reduce = ReduceOp::None;
+    if (parallel && match(TokenType::IDENTIFIER) && symbolName(current().symbol) == "reduce") {
+        consume();
+
+        Token op = consume();
+        std::string opName = op.type == TokenType::IDENTIFIER ? symbolName(op.symbol) : "";
+
+        if (op.type == TokenType::PLUS) reduce = ReduceOp::Sum;
+        else if (op.type == TokenType::MUL) reduce = ReduceOp::Product;
+        else if (opName == "min") reduce = ReduceOp::Min;
+        else if (opName == "max") reduce = ReduceOp::Max;
+        else throw ParseError("Expected +, *, min or max after 'reduce'");
+    }
+
+    auto body = std::get<std::unique_ptr<BlockExpr>>(parseBlockExpr());
+
+    return std::make_unique<ForExpr>(ForExpr{
+        name.symbol, std::move(start), std::move(end), std::move(body), parallel, reduce, {}, false, at(keyword)
+    });
+}
+
+Expr Parser::parseLoopExpr() {
+    Token keyword = consume(); // Consume loop
+
+    auto body = std::get<std::unique_ptr<BlockExpr>>(parseBlockExpr());
+
+    return std::make_unique<LoopExpr>(LoopExpr{ std::move(body), at(keyword) });
 }
 
 Stmt Parser::parseFnDecl() {
-    consume();  // consume fn
+    Token keyword = consume();  // consume fn
     
     Token nameToken = expect(TokenType::IDENTIFIER, "Expected function name");
     
-    auto name = std::get<std::string>(nameToken.value);
+    auto name = nameToken.symbol;
     
     expect(TokenType::LEFT_PAREN, "Expected '(' after function name");
     
@@ -440,9 +742,9 @@ Stmt Parser::parseFnDecl() {
             
             expect(TokenType::COLON, "Expected ':' after parameter name");
             
-            Token paramType = expect(TokenType::IDENTIFIER, "Expected parameter type");
+            std::string paramType = parseTypeName();
             
-            params.push_back(Parameter{ std::get<std::string>(paramName.value), std::get<std::string>(paramType.value) });
+            params.push_back(Parameter{ paramName.symbol, paramType });
         } while (match(TokenType::COMMA) && (consume(), true));
     }
     
@@ -450,22 +752,45 @@ Stmt Parser::parseFnDecl() {
     
     std::string returnType;
     if (match(TokenType::IDENTIFIER)) {
-        auto idToken = consume();
-        returnType = std::get<std::string>(idToken.value);
+        returnType = parseTypeName();
     }
     
     auto body = std::get<std::unique_ptr<BlockExpr>>(parseBlockExpr());
 
     return std::make_unique<FunctionDecl>(FunctionDecl{
-        name, std::move(params), returnType, std::move(body)
+        name, std::move(params), returnType, std::move(body), 0, at(keyword)
     });
 }
 
+// struct Name { field: type, ... }
+Stmt Parser::parseStructDecl() {
+    Token keyword = consume(); // Consume struct
+
+    Token name = expect(TokenType::IDENTIFIER, "Expected a struct name");
+    expect(TokenType::LEFT_BRACE, "Expected '{' after the struct name");
+
+    std::vector<Parameter> fields;
+    while (!match(TokenType::RIGHT_BRACE)) {
+        Token field = expect(TokenType::IDENTIFIER, "Expected a field name");
+        expect(TokenType::COLON, "Expected ':' after the field name");
+
+        fields.push_back(Parameter{ field.symbol, parseTypeName() });
+
+        if (!match(TokenType::COMMA)) break;
+        consume();
+    }
+
+    expect(TokenType::RIGHT_BRACE, "Expected '}' after the fields");
+    if (fields.empty()) throw ParseError("A struct needs at least one field");
+
+    return std::make_unique<StructDecl>(StructDecl{ name.symbol, std::move(fields), at(keyword) });
+}
+
 Stmt Parser::parseImportStmt() {
-    consume(); // Consume import
+    Token keyword = consume(); // Consume import
 
-    std::vector<std::string> path;
-    path.push_back(std::get<std::string>(expect(TokenType::IDENTIFIER, "Expected module name").value));
+    std::vector<Symbol> path;
+    path.push_back(expect(TokenType::IDENTIFIER, "Expected module name").symbol);
 
     while (match(TokenType::DOT)) {
         consume();
@@ -473,20 +798,20 @@ Stmt Parser::parseImportStmt() {
         if (match(TokenType::MUL)) {
             consume();
             expect(TokenType::SEMICOLON, "Expected ';' after import");
-            return ImportStmt{ std::move(path), true };
+            return ImportStmt{ std::move(path), true, at(keyword) };
         }
 
-        path.push_back(std::get<std::string>(expect(TokenType::IDENTIFIER, "Expected identifier after .").value));
+        path.push_back(expect(TokenType::IDENTIFIER, "Expected identifier after .").symbol);
     }
 
     expect(TokenType::SEMICOLON, "Expected ';' after import");
-    return ImportStmt{ std::move(path), false };
+    return ImportStmt{ std::move(path), false, at(keyword) };
 }
 
 Stmt Parser::parseModuleDecl() {
-    consume(); // Consume module
+    Token keyword = consume(); // Consume module
 
-    auto mod_name = std::get<std::string>(expect(TokenType::IDENTIFIER, "Expected module name").value);
+    auto mod_name = expect(TokenType::IDENTIFIER, "Expected module name").symbol;
 
     expect(TokenType::LEFT_BRACE, "Expected an opening brace");
 
@@ -498,16 +823,21 @@ Stmt Parser::parseModuleDecl() {
 
     expect(TokenType::RIGHT_BRACE, "Expected a closing brace");
 
-    return std::make_unique<ModuleDecl>(mod_name, std::move(body));
+    return std::make_unique<ModuleDecl>(mod_name, std::move(body), at(keyword));
 }
 
 std::vector<Stmt> Parser::parse() {
     std::vector<Stmt> statements;
 
-    while (!isAtEnd()) {
-        statements.push_back(
-            std::move(parseStmt())
-        );
+    try {
+        while (!isAtEnd()) {
+            statements.push_back(
+                std::move(parseStmt())
+            );
+        }
+    } catch (const ParseError&) {
+        // Errors are reported at the token the parser stopped on
+        rethrowAt(at(current()));
     }
 
     return statements;
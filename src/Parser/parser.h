@@ -17,6 +17,7 @@ public:
 class Parser {
     std::vector<Token> tokens;
     size_t index = 0;
+    uint32_t file; // Source map file the positions of the nodes are recorded under
 
     bool isAtEnd();
 
@@ -34,10 +35,23 @@ class Parser {
     bool match_peek(const std::initializer_list<TokenType>&);
     bool match_peek(TokenType);
 
+    bool isBlockLike(const Expr&);
+    bool isAssignment();
+
+    SourcePos at(const Token&);
+
+    std::string parseTypeName();
+
     Expr parseBlockExpr();
+    std::unique_ptr<BlockExpr> parseBlockBody(bool braced);
     Expr parseIfExpr();
     Expr parseWhileExpr();
+    Expr parseForExpr();
+    Expr parseLoopExpr();
 
+    Expr parseArrayExpr();
+    Expr parseStructExpr();
+    Expr parseMapExpr();
     Expr parsePrimary();
     Expr parsePostfix();
     Expr parseUnary();
@@ -48,7 +62,9 @@ class Parser {
 
     Stmt parseLetStmt();
     Stmt parseAssignment();
+    Stmt parseIndexAssignment(Expr target);
     Stmt parseFnDecl();
+    Stmt parseStructDecl();
 
     Stmt parseImportStmt();
     Stmt parseModuleDecl();
@@ -56,7 +72,11 @@ class Parser {
     Stmt parseStmt();
 
 public:
-    Parser(const std::vector<Token>&);
+    // Without a file (from SourceMap::openFile) no positions are recorded
+    Parser(const std::vector<Token>&, uint32_t file = 0);
 
     std::vector<Stmt> parse();
+
+    // Parses input that is the inside of a block without the braces (REPL input)
+    std::unique_ptr<BlockExpr> parseBlockContents();
 };
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+#include "Profiler/Allocations.h"
+
+// Counting costs every allocation a size query and atomic updates that all threads contend on,
+// so only builds that ask for it replace the allocator
+#ifdef RAFT_ALLOC_PROFILE
+namespace {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> live{0};
+    std::atomic<uint64_t> peak{0};
+
+    struct Site {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    Site phaseSites[allocationProfile::MaxPhases];
+    Site nodeSites[allocationProfile::MaxNodeKinds];
+
+    std::vector<std::string> phaseNames = { "(outside phases)" };
+    std::unordered_map<std::string, int> phaseIndex;
+
+    void charge(Site& site, size_t block) {
+        site.count.fetch_add(1, std::memory_order_relaxed);
+        site.bytes.fetch_add(block, std::memory_order_relaxed);
+    }
+
+    // The allocator's own idea of the block size, so new and delete agree without a header
+    size_t blockSize(void* p) {
+#if defined(_WIN32)
+        return _msize(p);
+#elif defined(__APPLE__)
+        return malloc_size(p);
+#else
+        return malloc_usable_size(p);
+#endif
+    }
+
+    void* allocate(size_t size) noexcept {
+        void* p = std::malloc(size ? size : 1);
+        if (!p) return nullptr;
+
+        size_t block = blockSize(p);
+        count.fetch_add(1, std::memory_order_relaxed);
+        bytes.fetch_add(block, std::memory_order_relaxed);
+
+        uint64_t now = live.fetch_add(block, std::memory_order_relaxed) + block;
+        uint64_t high = peak.load(std::memory_order_relaxed);
+        while (now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {}
+
+        if (allocationProfile::enabled) {
+            charge(phaseSites[allocationProfile::phase], block);
+            if (allocationProfile::node >= 0) charge(nodeSites[allocationProfile::node], block);
+        }
+
+        return p;
+    }
+
+    void release(void* p) noexcept {
+        if (!p) return;
+
+        live.fetch_sub(blockSize(p), std::memory_order_relaxed);
+        std::free(p);
+    }
+}
+
+AllocationCounters allocationCounters() {
+    return AllocationCounters{
+        count.load(std::memory_order_relaxed),
+        bytes.load(std::memory_order_relaxed),
+        live.load(std::memory_order_relaxed),
+        peak.load(std::memory_order_relaxed)
+    };
+}
+
+void resetAllocationPeak(uint64_t value) {
+    peak.store(value, std::memory_order_relaxed);
+}
+
+int allocationProfile::phaseSite(const std::string& name) {
+    auto it = phaseIndex.find(name);
+    if (it != phaseIndex.end()) return it->second;
+
+    // Phases past the table share the last slot
+    if (phaseNames.size() >= MaxPhases) return MaxPhases - 1;
+
+    int index = static_cast<int>(phaseNames.size());
+    phaseNames.push_back(name);
+    phaseIndex.emplace(name, index);
+
+    return index;
+}
+
+void allocationProfile::clear() {
+    for (auto& site : phaseSites) site.count = 0, site.bytes = 0;
+    for (auto& site : nodeSites) site.count = 0, site.bytes = 0;
+}
+
+static void printRanked(std::ostream& out, const char* title, const std::vector<std::pair<std::string, const Site*>>& sites) {
+    std::vector<std::pair<std::string, const Site*>> ranked;
+    uint64_t totalBytes = 0;
+
+    for (const auto& entry : sites) {
+        if (entry.second->count == 0) continue;
+
+        ranked.push_back(entry);
+        totalBytes += entry.second->bytes;
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.second->bytes > b.second->bytes; });
+
+    out << title << "\n";
+    out << "  " << std::left << std::setw(32) << "site" << std::right
+        << std::setw(12) << "allocs" << std::setw(14) << "bytes" << std::setw(9) << "bytes%" << "\n";
+
+    for (const auto& [name, site] : ranked) {
+        out << "  " << std::left << std::setw(32) << name << std::right
+            << std::setw(12) << site->count << std::setw(14) << site->bytes
+            << std::setw(8) << std::fixed << std::setprecision(1) << 100.0 * site->bytes / totalBytes << "%\n";
+    }
+}
+
+void allocationProfile::print(std::ostream& out, const std::vector<const char*>& nodeNames) {
+    std::vector<std::pair<std::string, const Site*>> phases, nodes;
+
+    for (size_t i = 0; i < phaseNames.size(); i++) phases.emplace_back(phaseNames[i], &phaseSites[i]);
+    for (size_t i = 0; i < nodeNames.size() && i < MaxNodeKinds; i++) nodes.emplace_back(nodeNames[i], &nodeSites[i]);
+
+    printRanked(out, "Allocations by phase (innermost)", phases);
+    printRanked(out, "Allocations by AST node kind while executing (innermost)", nodes);
+}
+
+void* operator new(size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = allocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+#else
+AllocationCounters allocationCounters() {
+    return AllocationCounters{};
+}
+
+void resetAllocationPeak(uint64_t) {}
+#endif
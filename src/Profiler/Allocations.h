@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Built with -DRAFT_ALLOC_PROFILE=ON, global operator new/delete are replaced with versions that
+// keep these counters. Other builds use the allocator as it is, and the counters stay at zero.
+#ifdef RAFT_ALLOC_PROFILE
+constexpr bool allocationCounting = true;
+#else
+constexpr bool allocationCounting = false;
+#endif
+
+struct AllocationCounters {
+    uint64_t count = 0; // Allocations made
+    uint64_t bytes = 0; // Bytes allocated
+    uint64_t live = 0;  // Bytes currently allocated
+    uint64_t peak = 0;  // High-water mark of live bytes since the last resetPeak
+};
+
+AllocationCounters allocationCounters();
+
+// Restarts the high-water mark from `bytes` (so a phase can measure its own peak)
+void resetAllocationPeak(uint64_t bytes);
+
+#ifdef RAFT_ALLOC_PROFILE
+// Built with -DRAFT_ALLOC_PROFILE=ON: with --alloc-profile every allocation is also charged
+// to the innermost phase and, while the program runs, to the kind of AST node being evaluated
+namespace allocationProfile {
+    constexpr int MaxPhases = 256;
+    constexpr int MaxNodeKinds = 64;
+
+    inline bool enabled = false;
+    inline thread_local int phase = 0; // Index from phaseSite, 0 outside any phase
+    inline thread_local int node = -1; // Node kind being evaluated, -1 outside execution
+
+    // Index of a phase name, registering it on first use (never called from operator new)
+    int phaseSite(const std::string& name);
+
+    void clear();
+
+    // Ranked by bytes; nodeNames[kind] names each node kind
+    void print(std::ostream&, const std::vector<const char*>& nodeNames);
+
+    class NodeScope {
+    public:
+        explicit NodeScope(int kind) : previous(node) { node = kind; }
+        ~NodeScope() { node = previous; }
+
+    private:
+        int previous;
+    };
+}
+
+#define RAFT_ALLOCATION_NODE(kind) allocationProfile::NodeScope allocationNodeScope(static_cast<int>(kind))
+#else
+#define RAFT_ALLOCATION_NODE(kind)
+#endif
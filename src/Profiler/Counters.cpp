@@ -0,0 +1,130 @@
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "Profiler/Counters.h"
+#include "Profiler/Phases.h"
+
+#ifdef __linux__
+static int openCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof attr;
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // This thread on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+static uint64_t cacheEvent(uint64_t cache, uint64_t result) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+}
+#endif
+
+bool HardwareCounters::open() {
+#ifdef __linux__
+    if (opened) return true;
+
+    // Opened one by one rather than as a group so that a PMU with few counters multiplexes
+    // them instead of refusing, and a missing event doesn't take the others down with it
+    fds[Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[Branches] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+    fds[BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds[L1Loads] = openCounter(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_ACCESS));
+    fds[L1Misses] = openCounter(PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS));
+    fds[LLCReferences] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+    fds[LLCMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    for (int fd : fds) opened = opened || fd >= 0;
+    return opened;
+#else
+    return false;
+#endif
+}
+
+void HardwareCounters::close() {
+#ifdef __linux__
+    for (int& fd : fds) {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+#endif
+    opened = false;
+}
+
+CounterValues HardwareCounters::read() const {
+    CounterValues values{};
+
+#ifdef __linux__
+    for (int i = 0; i < HardwareEventCount; i++) {
+        if (fds[i] < 0) continue;
+
+        uint64_t data[3]; // value, time enabled, time running
+        if (::read(fds[i], data, sizeof data) != sizeof data || data[2] == 0) continue;
+
+        values[i] = data[2] < data[1] ? static_cast<uint64_t>(data[0] * (double(data[1]) / data[2])) : data[0];
+    }
+#endif
+
+    return values;
+}
+
+static std::string formatCount(uint64_t count) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+
+    if (count >= 1000000000) out << count / 1e9 << " G";
+    else if (count >= 1000000) out << count / 1e6 << " M";
+    else if (count >= 1000) out << count / 1e3 << " K";
+    else out << count;
+
+    return out.str();
+}
+
+static std::string formatRatio(bool available, uint64_t part, uint64_t whole, bool percent) {
+    if (!available || whole == 0) return "-";
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (percent) out << 100.0 * part / whole << "%";
+    else out << double(part) / whole;
+
+    return out.str();
+}
+
+void printHardwareCounters(std::ostream& out, const std::vector<PhaseRecord>& records) {
+    const auto& hw = hardwareCounters;
+    bool ipc = hw.available(Cycles) && hw.available(Instructions);
+    bool branches = hw.available(Branches) && hw.available(BranchMisses);
+    bool l1 = hw.available(L1Loads) && hw.available(L1Misses);
+    bool llc = hw.available(LLCReferences) && hw.available(LLCMisses);
+
+    out << "Hardware counters\n";
+    out << "  " << std::left << std::setw(32) << "phase" << std::right
+        << std::setw(12) << "cycles" << std::setw(12) << "instrs" << std::setw(8) << "IPC"
+        << std::setw(12) << "branch miss" << std::setw(10) << "L1d miss" << std::setw(10) << "LLC miss" << "\n";
+
+    for (const auto& record : records) {
+        const auto& c = record.counters;
+        std::string name = std::string(record.depth * 2, ' ') + record.name;
+
+        out << "  " << std::left << std::setw(32) << name << std::right
+            << std::setw(12) << (hw.available(Cycles) ? formatCount(c[Cycles]) : "-")
+            << std::setw(12) << (hw.available(Instructions) ? formatCount(c[Instructions]) : "-")
+            << std::setw(8) << formatRatio(ipc, c[Instructions], c[Cycles], false)
+            << std::setw(12) << formatRatio(branches, c[BranchMisses], c[Branches], true)
+            << std::setw(10) << formatRatio(l1, c[L1Misses], c[L1Loads], true)
+            << std::setw(10) << formatRatio(llc, c[LLCMisses], c[LLCReferences], true) << "\n";
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+struct PhaseRecord;
+
+enum HardwareEvent {
+    Cycles,
+    Instructions,
+    Branches,
+    BranchMisses,
+    L1Loads,
+    L1Misses,
+    LLCReferences,
+    LLCMisses,
+    HardwareEventCount
+};
+
+using CounterValues = std::array<uint64_t, HardwareEventCount>;
+
+// CPU performance counters for --profile=hw, read with perf_event_open on Linux.
+// Counters count this thread from open() on; a phase reads them at both ends.
+class HardwareCounters {
+public:
+    HardwareCounters() { fds.fill(-1); }
+
+    // Returns false if no counter could be opened (other platforms, or perf_event_paranoid)
+    bool open();
+    void close();
+
+    bool isOpen() const { return opened; }
+    bool available(HardwareEvent event) const { return fds[event] >= 0; }
+
+    // Current totals, scaled up when the kernel had to multiplex the counters
+    CounterValues read() const;
+
+private:
+    bool opened = false;
+    std::array<int, HardwareEventCount> fds;
+};
+
+inline HardwareCounters hardwareCounters;
+
+// Prints cycles, instructions, IPC and miss rates of each phase
+void printHardwareCounters(std::ostream& out, const std::vector<PhaseRecord>& records);
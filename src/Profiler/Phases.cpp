@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "Profiler/Phases.h"
+#include "Profiler/Allocations.h"
+#include "Profiler/Trace.h"
+
+PhaseScope::PhaseScope(std::string phaseName) : logged(phaseLog.enabled), traced(tracer.enabled) {
+#ifdef RAFT_ALLOC_PROFILE
+    if (allocationProfile::enabled) {
+        outerSite = allocationProfile::phase;
+        allocationProfile::phase = allocationProfile::phaseSite(phaseName);
+    }
+#endif
+
+    if (!logged && !traced) return;
+
+    if (logged) {
+        // The record is added up front so that a phase is listed before the phases nested in it
+        index = phaseLog.records.size();
+        phaseLog.records.push_back(PhaseRecord{ traced ? phaseName : std::move(phaseName), phaseLog.depth++ });
+
+        if (allocationCounting) {
+            auto counters = allocationCounters();
+            startCount = counters.count;
+            startBytes = counters.bytes;
+
+            // Measure this phase's own high-water mark, the enclosing phase's is restored afterwards
+            outerPeak = counters.peak;
+            resetAllocationPeak(counters.live);
+        }
+    }
+
+    if (traced) name = std::move(phaseName);
+
+    // Read last so that the bookkeeping above isn't counted
+    if (logged && hardwareCounters.isOpen()) startCounters = hardwareCounters.read();
+
+    startNanos = traceClockNanos();
+}
+
+PhaseScope::~PhaseScope() {
+#ifdef RAFT_ALLOC_PROFILE
+    if (allocationProfile::enabled) allocationProfile::phase = outerSite;
+#endif
+
+    if (!logged && !traced) return;
+
+    CounterValues endCounters{};
+    if (logged && hardwareCounters.isOpen()) endCounters = hardwareCounters.read();
+
+    int64_t endNanos = traceClockNanos();
+
+    if (traced) tracer.span(name, startNanos, endNanos);
+
+    if (!logged) return;
+
+    auto& record = phaseLog.records[index];
+    record.milliseconds = (endNanos - startNanos) / 1e6;
+
+    if (allocationCounting) {
+        auto counters = allocationCounters();
+        record.allocations = counters.count - startCount;
+        record.bytes = counters.bytes - startBytes;
+        record.peakBytes = counters.peak;
+
+        resetAllocationPeak(std::max(outerPeak, counters.peak));
+    }
+
+    for (int i = 0; i < HardwareEventCount; i++) record.counters[i] = endCounters[i] - startCounters[i];
+
+    phaseLog.depth--;
+}
+
+static std::string formatBytes(uint64_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+
+    if (bytes >= (1u << 20)) out << bytes / double(1u << 20) << " MB";
+    else if (bytes >= 1024) out << bytes / 1024.0 << " KB";
+    else out << bytes << " B";
+
+    return out.str();
+}
+
+// Allocations are only counted in builds configured with -DRAFT_ALLOC_PROFILE=ON
+void PhaseLog::print(std::ostream& out) const {
+    out << "Phase timings" << (allocationCounting ? "" : " (allocations: n/a, configure with -DRAFT_ALLOC_PROFILE=ON)") << "\n";
+    out << "  " << std::left << std::setw(40) << "phase" << std::right
+        << std::setw(12) << "ms" << std::setw(12) << "allocs" << std::setw(12) << "bytes" << std::setw(12) << "peak heap" << "\n";
+
+    for (const auto& record : records) {
+        std::string name = std::string(record.depth * 2, ' ') + record.name;
+
+        out << "  " << std::left << std::setw(40) << name << std::right
+            << std::setw(12) << std::fixed << std::setprecision(3) << record.milliseconds
+            << std::setw(12) << (allocationCounting ? std::to_string(record.allocations) : "n/a")
+            << std::setw(12) << (allocationCounting ? formatBytes(record.bytes) : "n/a")
+            << std::setw(12) << (allocationCounting ? formatBytes(record.peakBytes) : "n/a") << "\n";
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Profiler/Counters.h"
+
+// Cost of one compilation phase (or one file within it), reported with --time-phases
+struct PhaseRecord {
+    std::string name;
+    int depth;              // Phases nest, e.g. parsing one file inside loading modules
+    double milliseconds = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    uint64_t peakBytes = 0; // Highest live heap while the phase ran
+    CounterValues counters{}; // With --profile=hw
+};
+
+class PhaseLog {
+public:
+    bool enabled = false;
+
+    std::vector<PhaseRecord> records;
+    int depth = 0;
+
+    void clear() {
+        records.clear();
+        depth = 0;
+    }
+
+    void print(std::ostream&) const;
+};
+
+inline PhaseLog phaseLog;
+
+// Measures the enclosing scope as one phase when phase timing or tracing is on
+class PhaseScope {
+public:
+    explicit PhaseScope(std::string phaseName);
+    ~PhaseScope();
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+
+private:
+    bool logged;
+    bool traced;
+    std::string name; // Only kept for the trace
+    size_t index = 0;
+    int64_t startNanos = 0;
+    uint64_t startCount = 0;
+    uint64_t startBytes = 0;
+    uint64_t outerPeak = 0;
+    CounterValues startCounters{};
+    int outerSite = 0; // Allocation profile phase to restore
+};
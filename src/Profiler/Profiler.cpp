@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/time.h>
+#define RAFT_HAS_SIGPROF 1
+#endif
+
+#include "Profiler/Profiler.h"
+
+namespace {
+    // Samples are stored back to back as [depth, position, frame 0 (outermost), ..., frame depth-1]
+    constexpr size_t BufferSize = 1 << 21;
+    constexpr size_t MaxHotLines = 20;
+
+    std::unique_ptr<uintptr_t[]> buffer;
+    volatile size_t used = 0;
+    volatile size_t samples = 0;
+    volatile size_t dropped = 0;
+
+    // Only touches preallocated memory, so it is async-signal-safe
+    void onSample(int) {
+        std::atomic_signal_fence(std::memory_order_acquire);
+
+        int depth = std::min<int>(static_cast<int>(callstack::depth), callstack::MaxDepth);
+        if (used + depth + 2 > BufferSize) {
+            dropped = dropped + 1;
+            return;
+        }
+
+        size_t at = used;
+        buffer[at++] = static_cast<uintptr_t>(depth);
+        buffer[at++] = static_cast<uintptr_t>(callstack::position);
+        for (int i = 0; i < depth; i++) buffer[at++] = reinterpret_cast<uintptr_t>(callstack::frames[i]);
+
+        used = at;
+        samples = samples + 1;
+    }
+}
+
+bool Profiler::start(int intervalMicros) {
+#ifdef RAFT_HAS_SIGPROF
+    interval = intervalMicros;
+    buffer = std::make_unique<uintptr_t[]>(BufferSize);
+    callstack::tracksPositions = true;
+    used = 0;
+    samples = 0;
+    dropped = 0;
+
+    struct sigaction action {};
+    action.sa_handler = onSample;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, nullptr);
+
+    itimerval timer {};
+    timer.it_interval.tv_usec = intervalMicros;
+    timer.it_value.tv_usec = intervalMicros;
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+#else
+    return false;
+#endif
+}
+
+void Profiler::stop() {
+#ifdef RAFT_HAS_SIGPROF
+    itimerval timer {};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    signal(SIGPROF, SIG_IGN);
+#endif
+
+    callstack::tracksPositions = false;
+}
+
+void Profiler::report(std::ostream& out, const std::unordered_map<ProfileFrame, std::string>& names, const std::string& foldedPath) {
+    auto nameOf = [&](uintptr_t frame) -> std::string {
+        auto it = names.find(reinterpret_cast<ProfileFrame>(frame));
+        return it != names.end() ? it->second : "<unknown>";
+    };
+
+    std::unordered_map<uintptr_t, size_t> self, total;
+    std::unordered_map<std::string, size_t> lines; // Samples by file:line of the innermost node
+    std::map<std::string, size_t> folded;
+
+    for (size_t at = 0; at < used;) {
+        size_t depth = buffer[at++];
+        SourcePos position = static_cast<SourcePos>(buffer[at++]);
+        const uintptr_t* frames = &buffer[at];
+        at += depth;
+
+        std::string stack;
+        for (size_t i = 0; i < depth; i++) stack += (i ? ";" : "") + nameOf(frames[i]);
+        folded[depth ? stack : "<top level>"]++;
+
+        std::string line = SourceMap::global().describeLine(position);
+        lines[line.empty() ? "<unknown>" : line]++;
+
+        if (depth == 0) continue;
+        self[frames[depth - 1]]++;
+
+        // A recursive function is counted once per sample
+        for (size_t i = 0; i < depth; i++) {
+            if (std::find(frames, frames + i, frames[i]) == frames + i) total[frames[i]]++;
+        }
+    }
+
+    std::vector<std::pair<uintptr_t, size_t>> hot(total.begin(), total.end());
+    std::sort(hot.begin(), hot.end(), [&](const auto& a, const auto& b) {
+        return self[a.first] != self[b.first] ? self[a.first] > self[b.first] : a.second > b.second;
+    });
+
+    double count = samples ? static_cast<double>(samples) : 1.0;
+
+    out << "Profile: " << samples << " samples every " << interval << " us";
+    if (dropped) out << " (" << dropped << " dropped, buffer full)";
+    out << "\n";
+    out << "   self%  total%  samples  function\n";
+
+    for (const auto& [frame, totalCount] : hot) {
+        out << std::fixed << std::setprecision(1)
+            << std::setw(8) << 100.0 * self[frame] / count
+            << std::setw(8) << 100.0 * totalCount / count
+            << std::setw(9) << self[frame] << "  " << nameOf(frame) << "\n";
+    }
+
+    std::vector<std::pair<std::string, size_t>> hotLines(lines.begin(), lines.end());
+    std::sort(hotLines.begin(), hotLines.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if (hotLines.size() > MaxHotLines) hotLines.resize(MaxHotLines);
+
+    out << "\n   self%  samples  line\n";
+    for (const auto& [line, n] : hotLines) {
+        out << std::fixed << std::setprecision(1)
+            << std::setw(8) << 100.0 * n / count
+            << std::setw(9) << n << "  " << line << "\n";
+    }
+
+    std::ofstream file(foldedPath);
+    if (!file) {
+        out << "Could not write collapsed stacks to " << foldedPath << "\n";
+        return;
+    }
+
+    for (const auto& [stack, n] : folded) file << stack << " " << n << "\n";
+    out << "Collapsed stacks written to " << foldedPath << "\n";
+}
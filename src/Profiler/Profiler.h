@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <csignal>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "Util/source.h"
+
+// A FunctionDecl* or NativeFunctionDef*; names are looked up when the report is printed
+using ProfileFrame = const void*;
+
+// Shadow stack of the functions the interpreter is executing. Kept up to date on every call
+// (two stores), read by the sampling signal handler.
+namespace callstack {
+    constexpr int MaxDepth = 256;
+
+    // Per thread; par for workers block SIGPROF, so samples always read the main thread's stack
+    inline thread_local ProfileFrame frames[MaxDepth];
+    inline thread_local volatile std::sig_atomic_t depth = 0;
+
+    // The innermost node being evaluated that has a position, for the per-line hot list. Only
+    // kept while the profiler runs, since finding a node's position takes a visit of the node.
+    inline bool tracksPositions = false;
+    inline thread_local volatile SourcePos position = 0;
+
+    // Makes pos the current position until the end of the scope (exceptions included); 0 keeps
+    // the enclosing node's
+    class PositionScope {
+    public:
+        explicit PositionScope(SourcePos pos) : active(pos != 0) {
+            if (!active) return;
+
+            previous = position;
+            position = pos;
+        }
+
+        ~PositionScope() {
+            if (active) position = previous;
+        }
+
+        PositionScope(const PositionScope&) = delete;
+        PositionScope& operator=(const PositionScope&) = delete;
+
+    private:
+        SourcePos previous = 0;
+        bool active;
+    };
+
+    inline void push(ProfileFrame frame) {
+        if (depth < MaxDepth) frames[depth] = frame;
+        std::atomic_signal_fence(std::memory_order_release);
+        depth = depth + 1;
+    }
+
+    inline void pop() {
+        depth = depth - 1;
+    }
+
+    inline void reset() {
+        depth = 0;
+        position = 0;
+    }
+}
+
+// Samples the shadow stack on a SIGPROF timer into a preallocated buffer
+class Profiler {
+public:
+    // Returns false if the platform has no profiling timer
+    bool start(int intervalMicros = 1000);
+    void stop();
+
+    // Prints hot lists of functions and of source lines, and writes collapsed stacks
+    // ("main;fib;fib 42") for flamegraph tools
+    void report(std::ostream& out, const std::unordered_map<ProfileFrame, std::string>& names, const std::string& foldedPath);
+
+private:
+    int interval = 1000;
+};
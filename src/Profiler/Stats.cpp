@@ -0,0 +1,50 @@
+#include <iomanip>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "Profiler/Stats.h"
+
+uint64_t peakRssBytes() {
+#if defined(__APPLE__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes on macOS
+#elif defined(__unix__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux
+#else
+    return 0;
+#endif
+}
+
+void printStats(std::ostream& out, const RuntimeStats& stats, bool json) {
+    const std::pair<const char*, uint64_t> rows[] = {
+        { "user_calls", stats.userCalls },
+        { "native_calls", stats.nativeCalls },
+        { "stack_growths", stats.stackGrowths },
+        { "local_accesses", stats.localAccesses },
+        { "global_accesses", stats.globalAccesses },
+        { "string_copies", stats.stringCopies },
+        { "control_flow_throws", stats.controlFlowThrows },
+        { "bounds_checks", stats.boundsChecks },
+        { "unchecked_indexes", stats.uncheckedIndexes },
+        { "peak_rss_bytes", peakRssBytes() },
+    };
+
+    if (json) {
+        out << "{";
+        for (size_t i = 0; i < std::size(rows); i++) {
+            out << (i ? ", " : "") << "\"" << rows[i].first << "\": " << rows[i].second;
+        }
+        out << "}\n";
+        return;
+    }
+
+    out << "Runtime statistics\n";
+    for (const auto& [name, value] : rows) {
+        out << "  " << std::left << std::setw(22) << name << std::right << value << "\n";
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Counters bumped by the interpreter as it runs, reported with --stats
+struct RuntimeStats {
+    uint64_t userCalls = 0;
+    uint64_t nativeCalls = 0;
+    uint64_t stackGrowths = 0;      // Reallocations of the value stack that holds every frame
+    uint64_t localAccesses = 0;     // Reads and writes of frame slots
+    uint64_t globalAccesses = 0;    // Reads and writes of global slots
+    uint64_t stringCopies = 0;      // Copies of RaftValues holding a string
+    uint64_t controlFlowThrows = 0; // break, continue and return are implemented with exceptions
+    uint64_t boundsChecks = 0;      // Array indexes checked at runtime
+    uint64_t uncheckedIndexes = 0;  // Array indexes the TypeChecker proved in bounds
+
+    RuntimeStats& operator+=(const RuntimeStats& other) {
+        userCalls += other.userCalls;
+        nativeCalls += other.nativeCalls;
+        stackGrowths += other.stackGrowths;
+        localAccesses += other.localAccesses;
+        globalAccesses += other.globalAccesses;
+        stringCopies += other.stringCopies;
+        controlFlowThrows += other.controlFlowThrows;
+        boundsChecks += other.boundsChecks;
+        uncheckedIndexes += other.uncheckedIndexes;
+        return *this;
+    }
+};
+
+// Per thread: the threads of a par for count on their own and add theirs to the loop's thread
+inline thread_local RuntimeStats runtimeStats;
+
+// Peak resident set size of the process, 0 where unknown
+uint64_t peakRssBytes();
+
+void printStats(std::ostream& out, const RuntimeStats& stats, bool json);
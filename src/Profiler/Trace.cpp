@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+
+#include "Profiler/Trace.h"
+
+int64_t traceClockNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void appendJsonString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out += c;
+    }
+    out += '"';
+}
+
+bool Tracer::open(const std::string& path, bool traceCalls) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    enabled = true;
+    calls = traceCalls;
+    first = true;
+    origin = traceClockNanos();
+
+    buffer = "{\"traceEvents\":[\n";
+    pending.reserve(BufferedCalls);
+
+    return true;
+}
+
+void Tracer::close() {
+    if (!enabled) return;
+
+    flushCalls();
+    buffer += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    writeBuffer();
+    file.close();
+
+    enabled = false;
+    calls = false;
+    names.clear();
+}
+
+void Tracer::setFrameNames(std::unordered_map<ProfileFrame, std::string> frameNames) {
+    names = std::move(frameNames);
+}
+
+void Tracer::span(const std::string& name, int64_t startNanos, int64_t endNanos) {
+    if (!enabled) return;
+
+    // Calls recorded so far go first so that events stay roughly in time order
+    flushCalls();
+    writeEvent(name, 'X', startNanos, endNanos - startNanos);
+}
+
+void Tracer::flushCalls() {
+    for (const auto& event : pending) {
+        auto it = names.find(event.frame);
+        writeEvent(it != names.end() ? it->second : "<unknown>", event.begin ? 'B' : 'E', event.nanos, -1);
+    }
+
+    pending.clear();
+    writeBuffer();
+}
+
+void Tracer::writeEvent(const std::string& name, char phase, int64_t nanos, int64_t durationNanos) {
+    char numbers[64];
+
+    if (!first) buffer += ",\n";
+    first = false;
+
+    buffer += "{\"name\":";
+    appendJsonString(buffer, name);
+    buffer += ",\"ph\":\"";
+    buffer += phase;
+
+    // Timestamps are microseconds since the trace was opened
+    std::snprintf(numbers, sizeof numbers, "\",\"ts\":%.3f", (nanos - origin) / 1e3);
+    buffer += numbers;
+
+    if (durationNanos >= 0) {
+        std::snprintf(numbers, sizeof numbers, ",\"dur\":%.3f", durationNanos / 1e3);
+        buffer += numbers;
+    }
+
+    buffer += ",\"pid\":1,\"tid\":1}";
+}
+
+void Tracer::writeBuffer() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
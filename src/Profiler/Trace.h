@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Profiler/Profiler.h"
+
+int64_t traceClockNanos();
+
+// Writes Chrome/Perfetto trace-event JSON for --trace. Compilation phases are written as
+// complete spans; function calls (with --trace-calls) are two small records each, kept in a
+// fixed buffer and written out with their qualified names whenever it fills up.
+class Tracer {
+public:
+    bool enabled = false;
+    bool calls = false;
+
+    bool open(const std::string& path, bool traceCalls);
+    void close();
+
+    // Names for the frames of call events, known once the program has been checked
+    void setFrameNames(std::unordered_map<ProfileFrame, std::string> names);
+
+    void span(const std::string& name, int64_t startNanos, int64_t endNanos);
+
+    void enter(ProfileFrame frame) { record(frame, true); }
+    void exit(ProfileFrame frame) { record(frame, false); }
+
+private:
+    struct CallEvent {
+        ProfileFrame frame;
+        int64_t nanos;
+        bool begin;
+    };
+
+    static constexpr size_t BufferedCalls = 1 << 16;
+
+    std::ofstream file;
+    std::string buffer;
+    std::vector<CallEvent> pending;
+    std::unordered_map<ProfileFrame, std::string> names;
+    int64_t origin = 0;
+    bool first = true;
+
+    void record(ProfileFrame frame, bool begin) {
+        pending.push_back(CallEvent{ frame, traceClockNanos(), begin });
+        if (pending.size() == BufferedCalls) flushCalls();
+    }
+
+    void flushCalls();
+    void writeEvent(const std::string& name, char phase, int64_t nanos, int64_t durationNanos);
+    void writeBuffer();
+};
+
+inline Tracer tracer;
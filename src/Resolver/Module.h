@@ -7,19 +7,111 @@
 #include <functional>
 
 #include "Util/token.h"
+#include "Util/symbol.h"
 #include "AST/AST.h"
 
 using NativeFunction = std::function<RaftValue(std::vector<RaftValue>&)>;
 
-enum class Type {
+enum class Type : uint32_t {
     Int,
     Double,
     Bool,
     String,
+    IntArray,
+    DoubleArray,
+    BoolArray,
+    StringArray,
+    AnyArray, // Natives only: a parameter that takes an array of any element type
+    // Natives only: int or double (int[] or double[]), the same in every generic parameter
+    // and result of one call, fixed by the first argument that has one of these types
+    Number,
+    NumberArray,
+    // Natives only: a map of any type, and the key and value types of the map argument of the call
+    AnyMap,
+    MapKey,
+    MapValue,
+    MapKeyArray,
+    MapValueArray,
+    // Map types: Map<int, V> for V int, double, bool and string, then the same with string keys
+    FirstMap,
+    LastMap = FirstMap + 7,
+    Builder, // std.string.builder()
+    File, // std.fs.open(), std.fs.create() and std.fs.appendTo()
     Void,
-    Unknown
+    Unknown,
+    // Struct types follow, numbered by StructLayout::id, each followed by the type of arrays of it
+    FirstStruct
 };
 
+inline bool isStruct(Type type) {
+    return type >= Type::FirstStruct && (static_cast<uint32_t>(type) - static_cast<uint32_t>(Type::FirstStruct)) % 2 == 0;
+}
+
+inline bool isStructArray(Type type) {
+    return type >= Type::FirstStruct && !isStruct(type);
+}
+
+inline Type structType(uint32_t id) {
+    return static_cast<Type>(static_cast<uint32_t>(Type::FirstStruct) + 2 * id);
+}
+
+inline uint32_t structId(Type type) {
+    return (static_cast<uint32_t>(type) - static_cast<uint32_t>(Type::FirstStruct)) / 2;
+}
+
+inline bool isArray(Type type) {
+    return type == Type::IntArray || type == Type::DoubleArray || type == Type::BoolArray || type == Type::StringArray || isStructArray(type);
+}
+
+// Array type with the given element type, or Unknown when there is none (arrays do not nest)
+inline Type arrayOf(Type element) {
+    if (isStruct(element)) return static_cast<Type>(static_cast<uint32_t>(element) + 1);
+
+    switch (element) {
+        case Type::Int: return Type::IntArray;
+        case Type::Double: return Type::DoubleArray;
+        case Type::Bool: return Type::BoolArray;
+        case Type::String: return Type::StringArray;
+
+        default: return Type::Unknown;
+    }
+}
+
+inline Type elementType(Type array) {
+    if (isStructArray(array)) return static_cast<Type>(static_cast<uint32_t>(array) - 1);
+
+    switch (array) {
+        case Type::IntArray: return Type::Int;
+        case Type::DoubleArray: return Type::Double;
+        case Type::BoolArray: return Type::Bool;
+        case Type::StringArray: return Type::String;
+
+        default: return Type::Unknown;
+    }
+}
+
+inline bool isMap(Type type) {
+    return type >= Type::FirstMap && type <= Type::LastMap;
+}
+
+// Map type with the given key and value types, or Unknown when maps can't have them
+inline Type mapOf(Type key, Type value) {
+    static_assert(static_cast<uint32_t>(Type::String) == 3, "Map types are numbered by value type");
+
+    if (key != Type::Int && key != Type::String) return Type::Unknown;
+    if (value > Type::String) return Type::Unknown;
+
+    return static_cast<Type>(static_cast<uint32_t>(Type::FirstMap) + (key == Type::String ? 4 : 0) + static_cast<uint32_t>(value));
+}
+
+inline Type mapKey(Type map) {
+    return static_cast<uint32_t>(map) - static_cast<uint32_t>(Type::FirstMap) >= 4 ? Type::String : Type::Int;
+}
+
+inline Type mapValue(Type map) {
+    return static_cast<Type>((static_cast<uint32_t>(map) - static_cast<uint32_t>(Type::FirstMap)) % 4);
+}
+
 struct FunctionSig {
     std::vector<Type> params;
     Type return_type;
@@ -32,6 +124,8 @@ struct NativeFunctionDef {
     Type returnType;
     NativeFunction impl;
     bool is_variadic = false;
+    bool changesArgument = false; // Changes its map, builder or file argument, which a par for body must not do
+    bool callsByName = false; // Runs a Raft function named at runtime, which the TypeChecker can't see (std.bench.run)
 };
 
 struct FunctionDecl;
@@ -42,11 +136,24 @@ struct FunctionInfo {
     FunctionSig signature;
 };
 
+// Lets natives run Raft code (std.bench). The interpreter installs itself while it exists, on
+// its own thread (par for workers have interpreters of their own).
+class NativeHost {
+public:
+    virtual ~NativeHost() = default;
+
+    // Finds a function by qualified name from the root module, e.g. "my_file.sub_mod.sum"
+    virtual const FunctionInfo& findFunction(const std::string& qualifiedName) = 0;
+    virtual RaftValue call(const FunctionInfo&, std::vector<RaftValue> args) = 0;
+};
+
+inline thread_local NativeHost* nativeHost = nullptr;
+
 struct Module {
-    std::string name;
-    std::unordered_map<std::string, FunctionInfo> functions;
-    std::unordered_map<std::string, std::unique_ptr<Module>> submodules;
-    std::unordered_map<std::string, Module*> aliases;
+    Symbol name;
+    std::unordered_map<Symbol, FunctionInfo> functions;
+    std::unordered_map<Symbol, std::unique_ptr<Module>> submodules;
+    std::unordered_map<Symbol, Module*> aliases;
     Module* parent = nullptr;
 };
 
@@ -0,0 +1,127 @@
+#include <fstream>
+#include <sstream>
+
+#include "Resolver/ModuleLoader.h"
+#include "Lexer/lexer.h"
+#include "Parser/parser.h"
+#include "Profiler/Phases.h"
+
+namespace fs = std::filesystem;
+
+std::vector<Stmt> parseFile(const std::string& filePath) {
+    std::string name = fs::path(filePath).filename().string();
+    std::stringstream buffer;
+
+    {
+        PhaseScope phase("read " + name);
+
+        std::ifstream file(filePath);
+        if (!file) {
+            throw std::runtime_error("Could not open file: " + filePath);
+        }
+        buffer << file.rdbuf();
+    }
+
+    std::vector<Token> tokens;
+
+    {
+        PhaseScope phase("lex " + name);
+
+        Lexer lexer;
+        tokens = lexer.scanTokens(buffer.str());
+        if (lexer.error()) {
+            throw std::runtime_error("Lexing failed in file: " + filePath);
+        }
+    }
+
+    PhaseScope phase("parse " + name);
+
+    Parser parser(tokens, openSourceFile(name));
+    return parser.parse();
+}
+
+ModuleLoader::ModuleLoader(const std::string& entryFilePath)
+: entryPath(fs::absolute(entryFilePath)), dir(entryPath.parent_path()) {}
+
+void ModuleLoader::beginRun() {
+    attempted.clear();
+    parsedThisRun = 0;
+    loadedThisRun = 0;
+}
+
+std::vector<Stmt> ModuleLoader::parseCached(const fs::path& file) {
+    loadedThisRun++;
+
+    auto modified = fs::last_write_time(file);
+    auto& cached = cache[file.string()];
+    if (cached.statements && cached.modified == modified) {
+        auto statements = std::move(*cached.statements);
+        cached.statements.reset();
+        return statements;
+    }
+
+    parsedThisRun++;
+    auto statements = parseFile(file.string());
+    cached = CachedFile{ modified, std::nullopt };
+    return statements;
+}
+
+std::vector<Stmt> ModuleLoader::loadEntry() {
+    return parseCached(entryPath);
+}
+
+Stmt ModuleLoader::loadModule(const fs::path& file, Symbol name) {
+    attempted.insert(name);
+    std::vector<Stmt> body = parseCached(file);
+
+    return std::make_unique<ModuleDecl>(ModuleDecl{ name, std::move(body) });
+}
+
+std::vector<Stmt> ModuleLoader::loadAll() {
+    std::vector<Stmt> moduleStmts;
+
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        if (entry.path().extension() != ".rft") continue;
+        if (fs::equivalent(entry.path(), entryPath)) continue;   // skip the entry file itself
+
+        moduleStmts.push_back(loadModule(entry.path(), intern(entry.path().stem().string())));
+    }
+
+    return moduleStmts;
+}
+
+std::optional<Stmt> ModuleLoader::load(Symbol name) {
+    if (attempted.count(name)) return std::nullopt;
+    attempted.insert(name);
+
+    fs::path file = dir / (symbolName(name) + ".rft");
+    if (!fs::is_regular_file(file) || file == entryPath) return std::nullopt;
+
+    // A file that fails to parse can be fixed and asked for again
+    try {
+        return loadModule(file, name);
+    } catch (const std::runtime_error&) {
+        attempted.erase(name);
+        throw;
+    }
+}
+
+void ModuleLoader::forget(Symbol name) {
+    attempted.erase(name);
+}
+
+void ModuleLoader::keep(std::vector<Stmt> entry, std::vector<Stmt> modules) {
+    // A tree is reused next run only while the file's modification time is unchanged
+    auto store = [&](const fs::path& file, std::vector<Stmt> statements) {
+        auto it = cache.find(file.string());
+        if (it != cache.end()) it->second.statements = std::move(statements);
+    };
+
+    store(entryPath, std::move(entry));
+
+    for (auto& stmt : modules) {
+        auto& module = std::get<std::unique_ptr<ModuleDecl>>(stmt);
+        store(dir / (symbolName(module->name) + ".rft"), std::move(module->body));
+    }
+}
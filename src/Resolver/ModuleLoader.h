@@ -0,0 +1,58 @@
+#pragma once
+
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <optional>
+
+#include "AST/AST.h"
+
+// Lexes and parses a whole file
+std::vector<Stmt> parseFile(const std::string& filePath);
+
+// Every .rft file next to the entry file is a module named after the file ("math.rft" --> mod math).
+// Parsed files can be handed back after a run (keep) so that a resident compiler only re-parses
+// the files whose modification time changed.
+class ModuleLoader {
+public:
+    explicit ModuleLoader(const std::string& entryFilePath);
+
+    // Starts a new run: forgets which modules were requested and resets the parse count
+    void beginRun();
+
+    std::vector<Stmt> loadEntry();
+
+    // Parses every sibling file up front
+    std::vector<Stmt> loadAll();
+
+    // Parses <dir>/<name>.rft on first request. Returns nothing if there is no such file or it was already loaded
+    std::optional<Stmt> load(Symbol name);
+
+    // Lets name be loaded again, after the REPL input that loaded it has been undone
+    void forget(Symbol name);
+
+    // Takes back the entry statements and module declarations produced by this loader
+    void keep(std::vector<Stmt> entry, std::vector<Stmt> modules);
+
+    const std::filesystem::path& directory() const { return dir; }
+    size_t filesParsed() const { return parsedThisRun; }
+    size_t filesLoaded() const { return loadedThisRun; }
+
+private:
+    struct CachedFile {
+        std::filesystem::file_time_type modified;
+        std::optional<std::vector<Stmt>> statements; // Empty while a run is using them
+    };
+
+    std::filesystem::path entryPath;
+    std::filesystem::path dir;
+
+    std::unordered_set<Symbol> attempted;
+    std::unordered_map<std::string, CachedFile> cache;
+
+    size_t parsedThisRun = 0;
+    size_t loadedThisRun = 0;
+
+    std::vector<Stmt> parseCached(const std::filesystem::path& file);
+    Stmt loadModule(const std::filesystem::path& file, Symbol name);
+};
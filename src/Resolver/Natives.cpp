@@ -1,7 +1,21 @@
 #include <variant>
 #include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <charconv>
+#include <cstdio>
 
 #include "Module.h"
+#include "Util/array.h"
+#include "Util/map.h"
+#include "Util/builder.h"
+#include "Kernels/Kernels.h"
+#include "Parallel/WorkPool.h"
+#include "IO/Console.h"
+#include "IO/File.h"
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
@@ -23,31 +37,134 @@ bool isInt(const RaftValue& val) {
     return std::holds_alternative<int64_t>(val);
 }
 
+RaftMap& asMap(const RaftValue& val) {
+    return *std::get<std::shared_ptr<RaftMap>>(val);
+}
+
+StringBuilder& asBuilder(const RaftValue& val) {
+    return *std::get<std::shared_ptr<StringBuilder>>(val);
+}
+
+// The file argument of a std.fs function, which has to be open, for reading or for writing as the function needs
+RaftFile& openFile(const RaftValue& val, const char* function, bool reading) {
+    RaftFile& file = *std::get<std::shared_ptr<RaftFile>>(val);
+
+    if (!file.isOpen()) throw std::runtime_error(std::string(function) + ": " + file.path + " is closed");
+    if (reading != (file.mode == RaftFile::Mode::Read)) {
+        throw std::runtime_error(std::string(function) + ": " + file.path + (reading ? " is open for writing" : " is open for reading"));
+    }
+
+    return file;
+}
+
 double asDouble(const RaftValue& val) {
     return std::get<double>(val);
 }
 
+RaftArray& asArray(const RaftValue& val) {
+    return *std::get<std::shared_ptr<RaftArray>>(val);
+}
+
+// A double argument that the type checker let through as an int
+double toDouble(const RaftValue& val) {
+    if (auto* i = std::get_if<int64_t>(&val)) return static_cast<double>(*i);
+    return std::get<double>(val);
+}
+
+// Arguments of the std.math array functions: int[] and double[] arrays of one kind
+void requireSameLength(const RaftArray& a, const RaftArray& b, const char* function) {
+    if (a.size() != b.size()) {
+        throw std::runtime_error(std::string(function) + ": arrays have different lengths (" +
+                                 std::to_string(a.size()) + " and " + std::to_string(b.size()) + ")");
+    }
+}
+
+void requireElements(const RaftArray& a, const char* function) {
+    if (a.size() == 0) throw std::runtime_error(std::string(function) + " of an empty array");
+}
+
+// Runs a reduction kernel over an int[] or double[] array
+template<class Reduce>
+RaftValue reduce(const RaftArray& a, Reduce kernel) {
+    if (a.kind == ElementKind::Int) return kernel(kernels().i64, a.data<int64_t>());
+    return kernel(kernels().f64, a.data<double>());
+}
+
+// Runs an elementwise kernel into a new array of the same kind
+template<class Map>
+RaftValue map(const RaftArray& a, Map kernel) {
+    auto out = std::make_shared<RaftArray>(a.kind, a.size(), defaultElement(a.kind));
+
+    if (a.kind == ElementKind::Int) kernel(kernels().i64, a.data<int64_t>(), out->data<int64_t>());
+    else kernel(kernels().f64, a.data<double>(), out->data<double>());
+
+    return out;
+}
+
+// sqrt and pow work on doubles, so int arrays are widened first
+std::vector<double> asDoubles(const RaftArray& a) {
+    if (a.kind == ElementKind::Double) return a.data<double>();
+
+    const auto& ints = a.data<int64_t>();
+    return std::vector<double>(ints.begin(), ints.end());
+}
+
+RaftValue doubleArray(std::vector<double> values) {
+    auto out = std::make_shared<RaftArray>(ElementKind::Double, 0, 0.0);
+    out->data<double>() = std::move(values);
+    return out;
+}
+
+int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// std.bench.run: times `iterations` calls of a function (after a tenth as many warmup calls)
+// and prints min/median/p99 and throughput. Returns calls per second.
+RaftValue benchFunction(const std::string& name, int64_t iterations) {
+    if (!nativeHost) throw std::runtime_error("std.bench.run needs a running program");
+    if (iterations < 1) throw std::runtime_error("std.bench.run needs at least one iteration");
+
+    const FunctionInfo& fn = nativeHost->findFunction(name);
+    if (!fn.signature.params.empty()) throw std::runtime_error("std.bench.run: " + name + " must take no parameters");
+
+    int64_t warmup = std::max<int64_t>(1, iterations / 10);
+    for (int64_t i = 0; i < warmup; i++) nativeHost->call(fn, {});
+
+    std::vector<int64_t> samples(iterations);
+    int64_t total = 0;
+
+    for (auto& sample : samples) {
+        int64_t start = monotonicNanos();
+        nativeHost->call(fn, {});
+        sample = monotonicNanos() - start;
+        total += sample;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](double p) { return samples[std::min<size_t>(samples.size() - 1, size_t(p * samples.size()))] / 1e3; };
+    double opsPerSecond = total > 0 ? iterations * 1e9 / total : 0;
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(2)
+           << "bench " << name << ": " << iterations << " runs (" << warmup << " warmup)"
+           << "  min " << samples.front() / 1e3 << " us"
+           << "  median " << percentile(0.5) << " us"
+           << "  p99 " << percentile(0.99) << " us"
+           << "  " << std::setprecision(0) << opsPerSecond << " ops/sec\n";
+    Output::standard().write(report.str());
+
+    return opsPerSecond;
+}
+
 std::vector<NativeFunctionDef> getAllNativeDefs() {
     std::vector<NativeFunctionDef> defs;
 
-    // --- std.io ---
+    // --- std.io (buffered, see IO/Console.h) ---
     defs.push_back({ "std.io.println", {}, Type::Void,
         [](std::vector<RaftValue>& args) -> RaftValue {
-            for (const auto& arg: args) {
-                if (isDouble(arg)) std::cout << std::get<double>(arg);
-
-                else if (isBool(arg)) {
-                    auto val = std::get<bool>(arg);
-
-                    if (val) std::cout << "true";
-                    else std::cout << "false";
-                } 
-                else if (isString(arg)) std::cout << std::get<std::string>(arg);
-                else if (isInt(arg)) std::cout << std::get<int64_t>(arg);
-                else std::cout << "None";
-            }
-            
-            std::cout << "\n";
+            Output::standard().print(args, true);
 
             return RaftValue{std::monostate{}};
         },
@@ -56,33 +173,97 @@ std::vector<NativeFunctionDef> getAllNativeDefs() {
     
     defs.push_back({ "std.io.print", {Type::String}, Type::Void,
         [](std::vector<RaftValue>& args) -> RaftValue {
-            for (const auto& arg: args) {
-                if (isDouble(arg)) std::cout << std::get<double>(arg);
-
-                else if (isBool(arg)) {
-                    auto val = std::get<bool>(arg);
-
-                    if (val) std::cout << "true";
-                    else std::cout << "false";
-                } 
-                else if (isString(arg)) std::cout << std::get<std::string>(arg);
-                else if (isInt(arg)) std::cout << std::get<int64_t>(arg);
-                else std::cout << "None";
-            }
+            Output::standard().print(args, false);
 
             return RaftValue{std::monostate{}};
         },
         true // is_variadic set to true
     });
 
+    defs.push_back({ "std.io.flush", {}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            Output::standard().flush();
+            return RaftValue{std::monostate{}};
+        }});
+
     defs.push_back({ "std.io.input", {}, Type::String,
         [](std::vector<RaftValue>& args) -> RaftValue {
             std::string line;
-            std::getline(std::cin, line);
+            readLine(line);
             return RaftValue{line};
         }}
     );
 
+    // --- std.fs (IO/File.h): whole files, and files read and written a block at a time ---
+    defs.push_back({ "std.fs.read", {Type::String}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue { return readFile(std::get<std::string>(args[0])); }});
+
+    defs.push_back({ "std.fs.exists", {Type::String}, Type::Bool,
+        [](std::vector<RaftValue>& args) -> RaftValue { return fileExists(std::get<std::string>(args[0])); }});
+
+    defs.push_back({ "std.fs.open", {Type::String}, Type::File,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return std::make_shared<RaftFile>(std::get<std::string>(args[0]), RaftFile::Mode::Read);
+        }});
+
+    defs.push_back({ "std.fs.create", {Type::String}, Type::File,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return std::make_shared<RaftFile>(std::get<std::string>(args[0]), RaftFile::Mode::Write);
+        }});
+
+    defs.push_back({ "std.fs.appendTo", {Type::String}, Type::File,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return std::make_shared<RaftFile>(std::get<std::string>(args[0]), RaftFile::Mode::Append);
+        }});
+
+    // Reads ahead to find out, so it counts as changing the file
+    defs.push_back({ "std.fs.done", {Type::File}, Type::Bool,
+        [](std::vector<RaftValue>& args) -> RaftValue { return openFile(args[0], "std.fs.done", true).atEnd(); },
+        false, true });
+
+    // "" at the end of the file, as std.io.input gives at the end of input
+    defs.push_back({ "std.fs.readLine", {Type::File}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::string line;
+            openFile(args[0], "std.fs.readLine", true).readLine(line);
+            return line;
+        }, false, true });
+
+    defs.push_back({ "std.fs.readChunk", {Type::File, Type::Int}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            int64_t size = std::get<int64_t>(args[1]);
+            if (size < 1) throw std::runtime_error("std.fs.readChunk: size must be positive");
+
+            return openFile(args[0], "std.fs.readChunk", true).readChunk(static_cast<size_t>(size));
+        }, false, true });
+
+    defs.push_back({ "std.fs.write", {Type::File, Type::String}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            openFile(args[0], "std.fs.write", false).write(std::get<std::string>(args[1]));
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.fs.writeLine", {Type::File, Type::String}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            RaftFile& file = openFile(args[0], "std.fs.writeLine", false);
+            file.write(std::get<std::string>(args[1]));
+            file.write("\n");
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.fs.flush", {Type::File}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            openFile(args[0], "std.fs.flush", false).flush();
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    // Closing a closed file does nothing
+    defs.push_back({ "std.fs.close", {Type::File}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::get<std::shared_ptr<RaftFile>>(args[0])->close();
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
         // --- std.math ---
     defs.push_back({ "std.math.sqrt", {Type{Type::Double}}, Type{Type::Double}, 
         [](std::vector<RaftValue>& args) -> RaftValue { return std::sqrt(asDouble(args[0])); }});
@@ -105,6 +286,85 @@ std::vector<NativeFunctionDef> getAllNativeDefs() {
             return std::max(asDouble(args[0]), asDouble(args[1]));
         }});
 
+    // --- std.math over arrays (SIMD kernels, see Kernels/Kernels.h) ---
+    defs.push_back({ "std.math.sum", {Type::NumberArray}, Type::Number,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return reduce(asArray(args[0]), [](const auto& k, const auto& v) { return k.sum(v.data(), v.size()); });
+        }});
+
+    defs.push_back({ "std.math.dot", {Type::NumberArray, Type::NumberArray}, Type::Number,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const RaftArray& b = asArray(args[1]);
+            requireSameLength(asArray(args[0]), b, "std.math.dot");
+
+            return reduce(asArray(args[0]), [&](const auto& k, const auto& v) {
+                return k.dot(v.data(), b.data<typename std::decay_t<decltype(v)>::value_type>().data(), v.size());
+            });
+        }});
+
+    defs.push_back({ "std.math.minOf", {Type::NumberArray}, Type::Number,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            requireElements(asArray(args[0]), "std.math.minOf");
+            return reduce(asArray(args[0]), [](const auto& k, const auto& v) { return k.min(v.data(), v.size()); });
+        }});
+
+    defs.push_back({ "std.math.maxOf", {Type::NumberArray}, Type::Number,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            requireElements(asArray(args[0]), "std.math.maxOf");
+            return reduce(asArray(args[0]), [](const auto& k, const auto& v) { return k.max(v.data(), v.size()); });
+        }});
+
+    defs.push_back({ "std.math.add", {Type::NumberArray, Type::NumberArray}, Type::NumberArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const RaftArray& b = asArray(args[1]);
+            requireSameLength(asArray(args[0]), b, "std.math.add");
+
+            return map(asArray(args[0]), [&](const auto& k, const auto& v, auto& out) {
+                k.add(v.data(), b.data<typename std::decay_t<decltype(v)>::value_type>().data(), out.data(), v.size());
+            });
+        }});
+
+    defs.push_back({ "std.math.mul", {Type::NumberArray, Type::NumberArray}, Type::NumberArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const RaftArray& b = asArray(args[1]);
+            requireSameLength(asArray(args[0]), b, "std.math.mul");
+
+            return map(asArray(args[0]), [&](const auto& k, const auto& v, auto& out) {
+                k.mul(v.data(), b.data<typename std::decay_t<decltype(v)>::value_type>().data(), out.data(), v.size());
+            });
+        }});
+
+    defs.push_back({ "std.math.scale", {Type::NumberArray, Type::Number}, Type::NumberArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const RaftValue& factor = args[1];
+
+            return map(asArray(args[0]), [&](const auto& k, const auto& v, auto& out) {
+                using T = typename std::decay_t<decltype(v)>::value_type;
+
+                if constexpr (std::is_same_v<T, double>) k.scale(v.data(), toDouble(factor), out.data(), v.size());
+                else k.scale(v.data(), std::get<int64_t>(factor), out.data(), v.size());
+            });
+        }});
+
+    defs.push_back({ "std.math.sqrtEach", {Type::NumberArray}, Type::DoubleArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::vector<double> values = asDoubles(asArray(args[0]));
+            kernels().sqrt(values.data(), values.data(), values.size());
+
+            return doubleArray(std::move(values));
+        }});
+
+    defs.push_back({ "std.math.powEach", {Type::NumberArray, Type::Double}, Type::DoubleArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::vector<double> values = asDoubles(asArray(args[0]));
+            kernels().pow(values.data(), toDouble(args[1]), values.data(), values.size());
+
+            return doubleArray(std::move(values));
+        }});
+
+    defs.push_back({ "std.math.simdLevel", {}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue { return std::string(simdLevelName(kernels().level)); }});
+
     // --- std.string ---
     defs.push_back({ "std.string.length", {Type{Type::String}}, Type{Type::Int}, 
         [](std::vector<RaftValue>& args) -> RaftValue {
@@ -125,5 +385,202 @@ std::vector<NativeFunctionDef> getAllNativeDefs() {
             return s;
         }});
 
+    // --- std.string bulk building (Util/builder.h): each result is allocated once ---
+    defs.push_back({ "std.string.builder", {}, Type::Builder,
+        [](std::vector<RaftValue>& args) -> RaftValue { return std::make_shared<StringBuilder>(); }});
+
+    defs.push_back({ "std.string.append", {Type::Builder, Type::String}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            asBuilder(args[0]).text += std::get<std::string>(args[1]);
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.string.appendInt", {Type::Builder, Type::Int}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            char digits[24];
+            auto end = std::to_chars(digits, digits + sizeof digits, std::get<int64_t>(args[1])).ptr;
+
+            asBuilder(args[0]).text.append(digits, end);
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    // Formatted as std.io.print shows doubles (%g)
+    defs.push_back({ "std.string.appendDouble", {Type::Builder, Type::Double}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            char digits[32];
+            int length = std::snprintf(digits, sizeof digits, "%g", toDouble(args[1]));
+
+            asBuilder(args[0]).text.append(digits, length);
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.string.reserve", {Type::Builder, Type::Int}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            int64_t length = std::get<int64_t>(args[1]);
+            if (length < 0) throw std::runtime_error("std.string.reserve: length must not be negative");
+
+            asBuilder(args[0]).text.reserve(static_cast<size_t>(length));
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    // A copy, so the builder can go on growing
+    defs.push_back({ "std.string.build", {Type::Builder}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue { return asBuilder(args[0]).text; }});
+
+    defs.push_back({ "std.string.join", {Type::StringArray, Type::String}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const auto& parts = asArray(args[0]).data<std::string>();
+            const auto& separator = std::get<std::string>(args[1]);
+            if (parts.empty()) return std::string();
+
+            size_t length = separator.size() * (parts.size() - 1);
+            for (const auto& part : parts) length += part.size();
+
+            std::string joined;
+            joined.reserve(length);
+
+            for (size_t i = 0; i < parts.size(); i++) {
+                if (i > 0) joined += separator;
+                joined += parts[i];
+            }
+
+            return joined;
+        }});
+
+    defs.push_back({ "std.string.repeat", {Type::String, Type::Int}, Type::String,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const auto& text = std::get<std::string>(args[0]);
+            int64_t times = std::get<int64_t>(args[1]);
+            if (times < 0) throw std::runtime_error("std.string.repeat: count must not be negative");
+            if (text.empty()) return std::string();
+
+            std::string repeated;
+            if (static_cast<uint64_t>(times) > repeated.max_size() / text.size()) {
+                throw std::runtime_error("std.string.repeat: result too large");
+            }
+
+            repeated.reserve(text.size() * times);
+            for (int64_t i = 0; i < times; i++) repeated += text;
+
+            return repeated;
+        }});
+
+    // The pieces between separators, empty ones included: split("a,,b", ",") is [a, , b]
+    defs.push_back({ "std.string.split", {Type::String, Type::String}, Type::StringArray,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::string_view text = std::get<std::string>(args[0]);
+            std::string_view separator = std::get<std::string>(args[1]);
+            if (separator.empty()) throw std::runtime_error("std.string.split: separator must not be empty");
+
+            auto out = std::make_shared<RaftArray>(ElementKind::String, 0, std::string());
+            auto& pieces = out->data<std::string>();
+
+            for (size_t start = 0;;) {
+                size_t end = text.find(separator, start);
+                if (end == std::string_view::npos) {
+                    pieces.emplace_back(text.substr(start));
+                    break;
+                }
+
+                pieces.emplace_back(text.substr(start, end - start));
+                start = end + separator.size();
+            }
+
+            return out;
+        }});
+
+    // --- std.array ---
+    defs.push_back({ "std.array.length", {Type{Type::AnyArray}}, Type{Type::Int},
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return static_cast<int64_t>(std::get<std::shared_ptr<RaftArray>>(args[0])->size());
+        }});
+
+    // --- std.collections (Map<K, V>, see Util/map.h) ---
+    defs.push_back({ "std.collections.set", {Type::AnyMap, Type::MapKey, Type::MapValue}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            asMap(args[0]).set(args[1], args[2]);
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.collections.get", {Type::AnyMap, Type::MapKey}, Type::MapValue,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            RaftValue value;
+            if (asMap(args[0]).get(args[1], value)) return value;
+
+            std::ostringstream key;
+            printValue(key, args[1]);
+            throw std::runtime_error("std.collections.get: the map has no key " + key.str());
+        }});
+
+    defs.push_back({ "std.collections.getOr", {Type::AnyMap, Type::MapKey, Type::MapValue}, Type::MapValue,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            RaftValue value;
+            if (asMap(args[0]).get(args[1], value)) return value;
+
+            // A double map's fallback may still be an int
+            if (asMap(args[0]).valueKind == ElementKind::Double) return toDouble(args[2]);
+            return args[2];
+        }});
+
+    defs.push_back({ "std.collections.has", {Type::AnyMap, Type::MapKey}, Type::Bool,
+        [](std::vector<RaftValue>& args) -> RaftValue { return asMap(args[0]).contains(args[1]); }});
+
+    defs.push_back({ "std.collections.remove", {Type::AnyMap, Type::MapKey}, Type::Bool,
+        [](std::vector<RaftValue>& args) -> RaftValue { return asMap(args[0]).remove(args[1]); },
+        false, true });
+
+    defs.push_back({ "std.collections.size", {Type::AnyMap}, Type::Int,
+        [](std::vector<RaftValue>& args) -> RaftValue { return static_cast<int64_t>(asMap(args[0]).size()); }});
+
+    defs.push_back({ "std.collections.reserve", {Type::AnyMap, Type::Int}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            int64_t count = std::get<int64_t>(args[1]);
+            if (count < 0) throw std::runtime_error("std.collections.reserve: count must not be negative");
+
+            asMap(args[0]).reserve(static_cast<size_t>(count));
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.collections.clear", {Type::AnyMap}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            asMap(args[0]).clear();
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.collections.putAll", {Type::AnyMap, Type::MapKeyArray, Type::MapValueArray}, Type::Void,
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            const RaftArray& values = asArray(args[2]);
+            requireSameLength(asArray(args[1]), values, "std.collections.putAll");
+
+            asMap(args[0]).setAll(asArray(args[1]), values);
+            return RaftValue{std::monostate{}};
+        }, false, true });
+
+    defs.push_back({ "std.collections.keys", {Type::AnyMap}, Type::MapKeyArray,
+        [](std::vector<RaftValue>& args) -> RaftValue { return asMap(args[0]).keys(); }});
+
+    defs.push_back({ "std.collections.values", {Type::AnyMap}, Type::MapValueArray,
+        [](std::vector<RaftValue>& args) -> RaftValue { return asMap(args[0]).values(); }});
+
+    // --- std.par ---
+    defs.push_back({ "std.par.threads", {}, Type{Type::Int},
+        [](std::vector<RaftValue>& args) -> RaftValue { return static_cast<int64_t>(WorkPool::global().size()); }});
+
+    // --- std.time ---
+    defs.push_back({ "std.time.nowNanos", {}, Type{Type::Int},
+        [](std::vector<RaftValue>& args) -> RaftValue { return monotonicNanos(); }});
+
+    defs.push_back({ "std.time.sleep", {Type{Type::Int}}, Type{Type::Void},
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            std::this_thread::sleep_for(std::chrono::milliseconds(std::get<int64_t>(args[0])));
+            return RaftValue{std::monostate{}};
+        }});
+
+    // --- std.bench ---
+    defs.push_back({ "std.bench.run", {Type{Type::String}, Type{Type::Int}}, Type{Type::Double},
+        [](std::vector<RaftValue>& args) -> RaftValue {
+            return benchFunction(std::get<std::string>(args[0]), std::get<int64_t>(args[1]));
+        }, false, false, true });
+
     return defs;
 }
\ No newline at end of file
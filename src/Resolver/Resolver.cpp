@@ -1,17 +1,49 @@
 #include <sstream>
+#include <utility>
+#include <optional>
+#include <algorithm>
 
 #include "Resolver.h"
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 
+namespace {
+    // Errors in declarations point at the declaration
+    [[noreturn]] void failAt(SourcePos pos, const std::string& message) {
+        try {
+            throw std::runtime_error(message);
+        } catch (const std::runtime_error&) {
+            rethrowAt(pos);
+        }
+    }
+}
+
 Type Resolver::typeFromString(const std::string& s) {
     if (s == "int") return Type::Int;
     if (s == "double") return Type::Double;
     if (s == "bool") return Type::Bool;
     if (s == "string") return Type::String;
+    if (s == "int[]") return Type::IntArray;
+    if (s == "double[]") return Type::DoubleArray;
+    if (s == "bool[]") return Type::BoolArray;
+    if (s == "string[]") return Type::StringArray;
+    if (s == "Builder") return Type::Builder;
+    if (s == "File") return Type::File;
     if (s == "") return Type::Void;
 
+    if (s.starts_with("Map<") && s.ends_with(">")) {
+        size_t comma = s.find(", ");
+        Type map = mapOf(typeFromString(s.substr(4, comma - 4)), typeFromString(s.substr(comma + 2, s.size() - comma - 3)));
+        if (map == Type::Unknown) throw std::runtime_error("Maps take int or string keys and int, double, bool or string values, not " + s);
+
+        return map;
+    }
+
+    bool array = s.ends_with("[]");
+    Type element = structNamed(intern(array ? s.substr(0, s.size() - 2) : s));
+    if (element != Type::Unknown) return array ? arrayOf(element) : element;
+
     throw std::runtime_error("Unknown type: " + s);
 }
 
@@ -21,25 +53,46 @@ std::string Resolver::typeToString(Type t) {
         case Type::Double: return "double";
         case Type::Bool: return "bool";
         case Type::String: return "string";
+        case Type::IntArray: return "int[]";
+        case Type::DoubleArray: return "double[]";
+        case Type::BoolArray: return "bool[]";
+        case Type::StringArray: return "string[]";
+        case Type::AnyArray: return "array";
+        case Type::Number: return "int or double";
+        case Type::NumberArray: return "int[] or double[]";
+        case Type::AnyMap: return "map";
+        case Type::MapKey: return "key";
+        case Type::MapValue: return "value";
+        case Type::MapKeyArray: return "key[]";
+        case Type::MapValueArray: return "value[]";
+        case Type::Builder: return "Builder";
+        case Type::File: return "File";
         case Type::Void: return "void";
 
-        default: return "unknown";
+        default:
+            if (isMap(t)) return "Map<" + typeToString(mapKey(t)) + ", " + typeToString(mapValue(t)) + ">";
+            if (isStruct(t)) return symbolName(layoutOf(t).name);
+            if (isStructArray(t)) return symbolName(layoutOf(elementType(t)).name) + "[]";
+
+            return "unknown";
     }
 }
 
-std::vector<std::string> Resolver::splitByDot(const std::string& s) {
-    std::vector<std::string> parts;
+// Only used once per native definition at registration; user code arrives pre-split by the parser
+std::vector<Symbol> Resolver::splitByDot(const std::string& s) {
+    std::vector<Symbol> parts;
     std::stringstream ss(s);
     std::string part;
-    while (std::getline(ss, part, '.')) parts.push_back(part);
+    while (std::getline(ss, part, '.')) parts.push_back(intern(part));
     return parts;
 }
 
-std::string Resolver::joinWithDots(const std::vector<std::string>& v) {
+// Only used for error messages
+std::string Resolver::joinWithDots(const std::vector<Symbol>& v) {
     auto result = std::string();
 
     for (size_t i = 0; i < v.size(); ++i) {
-        result.append(v[i]);
+        result.append(symbolName(v[i]));
 
         if (i != (v.size() - 1)) result.append(".");
     }
@@ -49,23 +102,13 @@ std::string Resolver::joinWithDots(const std::vector<std::string>& v) {
 
 void Resolver::registerNativeModules() {
     for (const auto& def : nativeDefs) {
-        std::vector<std::string> parts = splitByDot(def.qualifiedName);
-        std::string funcName = parts.back();
+        std::vector<Symbol> parts = splitByDot(def.qualifiedName);
+        Symbol funcName = parts.back();
         parts.pop_back();   // remaining parts are the module path, e.g. {"std", "io"}
         bool variadic = def.is_variadic; // For variadic functions (only for native functions)
 
         Module* mod = &root;
-        for (const auto& segment : parts) {
-            auto it = mod->submodules.find(segment);
-            if (it == mod->submodules.end()) {
-                auto newMod = std::make_unique<Module>();
-                newMod->name = segment;
-                newMod->parent = mod;
-                mod = mod->submodules.emplace(segment, std::move(newMod)).first->second.get();
-            } else {
-                mod = it->second.get();
-            }
-        }
+        for (const auto& segment : parts) mod = ensureSubmodule(mod, segment);
 
         FunctionInfo info;
         info.native_def = &def;
@@ -83,15 +126,12 @@ void Resolver::registerStmt(Stmt& stmt, Module* currentScope) {
             for (auto& p : fn->params) paramTypes.push_back(typeFromString(p.type));
             Type returnType = fn->returnType.empty() ? Type::Void : typeFromString(fn->returnType);
             info.signature = FunctionSig{ paramTypes, returnType };
-            currentScope->functions[fn->name] = info;
+            setFunction(currentScope, fn->name, info);
         },
 
         [&](std::unique_ptr<ModuleDecl>& mod) {
-            auto newMod = std::make_unique<Module>();
-            newMod->name = mod->name;
-            newMod->parent = currentScope;
-            Module* modPtr = newMod.get();
-            currentScope->submodules[mod->name] = std::move(newMod);
+            // Declaring a module that already exists adds to it
+            Module* modPtr = ensureSubmodule(currentScope, mod->name);
 
             for (auto& inner : mod->body) {
                 registerStmt(inner, modPtr);
@@ -101,13 +141,197 @@ void Resolver::registerStmt(Stmt& stmt, Module* currentScope) {
     }, stmt);
 }
 
-void Resolver::registerUserDeclarations(std::vector<Stmt>& program) {
+void Resolver::declare(std::vector<Stmt>& program) {
+    // Structs first: any function in the program may take or return any of them
+    for (auto& stmt : program) registerStructs(stmt);
+    layOutStructs();
+
     for (auto& stmt : program) {
         registerStmt(stmt, &root);
     }
 }
 
-const FunctionInfo* Resolver::tryResolveFrom(const std::vector<std::string>& nameParts, Module* scope) {
+void Resolver::registerStructs(const Stmt& stmt) {
+    if (auto* mod = std::get_if<std::unique_ptr<ModuleDecl>>(&stmt)) {
+        for (const auto& inner : (*mod)->body) registerStructs(inner);
+        return;
+    }
+
+    auto* decl = std::get_if<std::unique_ptr<StructDecl>>(&stmt);
+    if (!decl) return;
+
+    Symbol name = (*decl)->name;
+    if (structIds.count(name)) failAt((*decl)->pos, "Struct " + symbolName(name) + " is already declared");
+
+    auto layout = std::make_unique<StructLayout>();
+    layout->name = name;
+    layout->id = static_cast<uint32_t>(structs.size());
+
+    structIds[name] = layout->id;
+    pendingLayouts[layout.get()] = decl->get();
+    structs.push_back(std::move(layout));
+
+    if (recording) {
+        undoLog.push_back([this, name] {
+            pendingLayouts.erase(structs.back().get());
+            structIds.erase(name);
+            structs.pop_back();
+        });
+    }
+}
+
+void Resolver::layOutStructs() {
+    std::vector<const StructLayout*> visiting;
+
+    for (auto& layout : structs) {
+        if (pendingLayouts.count(layout.get())) layOut(*layout, visiting);
+    }
+
+    pendingLayouts.clear();
+}
+
+// Fields go in declaration order, each at the next offset that is a multiple of its alignment
+void Resolver::layOut(StructLayout& layout, std::vector<const StructLayout*>& visiting) {
+    if (layout.size > 0) return;
+
+    const StructDecl& decl = *pendingLayouts.at(&layout);
+    std::string name = symbolName(layout.name);
+
+    if (std::find(visiting.begin(), visiting.end(), &layout) != visiting.end()) failAt(decl.pos, "Struct " + name + " contains itself");
+    visiting.push_back(&layout);
+
+    uint32_t offset = 0;
+    for (const auto& declared : decl.fields) {
+        if (layout.field(declared.name)) failAt(decl.pos, "Struct " + name + " has two fields named " + symbolName(declared.name));
+
+        Type type;
+        try {
+            type = typeFromString(declared.type);
+        } catch (const std::runtime_error&) {
+            rethrowAt(decl.pos);
+        }
+
+        StructLayout::Field field{ declared.name, ElementKind::Int };
+        uint32_t size = 8;
+        uint32_t align = 8;
+
+        if (type == Type::Double) {
+            field.kind = ElementKind::Double;
+        } else if (type == Type::Bool) {
+            field.kind = ElementKind::Bool;
+            size = align = 1;
+        } else if (isStruct(type)) {
+            StructLayout& nested = *structs[structId(type)];
+            layOut(nested, visiting);
+
+            field.kind = ElementKind::Struct;
+            field.layout = &nested;
+            size = nested.size;
+            align = nested.align;
+        } else if (type != Type::Int) {
+            failAt(decl.pos, "Struct fields can be ints, doubles, bools or structs, not " + typeToString(type));
+        }
+
+        offset = (offset + align - 1) / align * align;
+        field.offset = offset;
+        offset += size;
+
+        layout.align = std::max(layout.align, align);
+        layout.fields.push_back(field);
+    }
+
+    layout.size = (offset + layout.align - 1) / layout.align * layout.align;
+    visiting.pop_back();
+}
+
+Type Resolver::structNamed(Symbol name) const {
+    auto it = structIds.find(name);
+    return it != structIds.end() ? structType(it->second) : Type::Unknown;
+}
+
+Module* Resolver::ensureSubmodule(Module* scope, Symbol name) {
+    auto it = scope->submodules.find(name);
+    if (it != scope->submodules.end()) return it->second.get();
+
+    auto newMod = std::make_unique<Module>();
+    newMod->name = name;
+    newMod->parent = scope;
+
+    if (recording) undoLog.push_back([scope, name] { scope->submodules.erase(name); });
+
+    return scope->submodules.emplace(name, std::move(newMod)).first->second.get();
+}
+
+std::string Resolver::signatureToString(const FunctionSig& sig) {
+    std::string text = "(";
+    for (size_t i = 0; i < sig.params.size(); i++) text += (i > 0 ? ", " : "") + typeToString(sig.params[i]);
+
+    return text + ") " + typeToString(sig.return_type);
+}
+
+void Resolver::setFunction(Module* scope, Symbol name, const FunctionInfo& info) {
+    if (recording) {
+        auto it = scope->functions.find(name);
+        std::optional<FunctionInfo> previous;
+        if (it != scope->functions.end()) previous = it->second;
+
+        // Earlier inputs were checked against the old signature and keep calling through this entry,
+        // so a REPL redefinition can replace the body but not the parameter or return types
+        if (previous) {
+            const FunctionSig& before = previous->signature;
+            const FunctionSig& after = info.signature;
+
+            if (before.params != after.params || before.return_type != after.return_type || before.is_variadic != after.is_variadic) {
+                std::string message = "Cannot redefine " + symbolName(name) + " as " + signatureToString(after) +
+                                      ": earlier inputs call it as " + signatureToString(before);
+
+                if (info.decl) failAt(info.decl->pos, message);
+                throw std::runtime_error(message);
+            }
+        }
+
+        undoLog.push_back([scope, name, previous] {
+            if (previous) scope->functions[name] = *previous;
+            else scope->functions.erase(name);
+        });
+    }
+
+    // Assigning in place keeps the FunctionInfo address that earlier call sites resolved to
+    scope->functions[name] = info;
+}
+
+void Resolver::setAlias(Symbol name, Module* module) {
+    if (recording) {
+        auto it = root.aliases.find(name);
+        Module* previous = it != root.aliases.end() ? it->second : nullptr;
+
+        undoLog.push_back([this, name, previous] {
+            if (previous) root.aliases[name] = previous;
+            else root.aliases.erase(name);
+        });
+    }
+
+    root.aliases[name] = module;
+}
+
+void Resolver::beginTransaction() {
+    recording = true;
+    undoLog.clear();
+}
+
+void Resolver::commit() {
+    recording = false;
+    undoLog.clear();
+}
+
+void Resolver::rollback() {
+    for (auto it = undoLog.rbegin(); it != undoLog.rend(); ++it) (*it)();
+
+    recording = false;
+    undoLog.clear();
+}
+
+const FunctionInfo* Resolver::tryResolveFrom(const std::vector<Symbol>& nameParts, Module* scope) {
     Module* mod = scope;
 
     for (size_t i = 0; i + 1 < nameParts.size(); ++i) {
@@ -125,115 +349,122 @@ const FunctionInfo* Resolver::tryResolveFrom(const std::vector<std::string>& nam
     return &it->second;
 }
 
-const FunctionInfo* Resolver::resolvePath(const std::vector<std::string>& nameParts, Module* currentScope) {
+const FunctionInfo* Resolver::resolvePath(const std::vector<Symbol>& nameParts, Module* currentScope) {
     for (Module* scope = currentScope; scope != nullptr; scope = scope->parent) {
         if (const FunctionInfo* found = tryResolveFrom(nameParts, scope)) {
             return found;
         }
     }
 
+    // The first segment may name a sibling file that has not been loaded yet
+    if (nameParts.size() > 1 && loadModule(nameParts[0])) return resolvePath(nameParts, currentScope);
+
     throw std::runtime_error("Cannot find : " + joinWithDots(nameParts));
 }
 
-void Resolver::resolveExpr(const Expr& expr, Module* currentScope) {
-    std::visit(overloaded{
-        [&](const std::unique_ptr<CallExpr>& e) {
-            e->resolved = resolvePath(e->name_parts, currentScope);
-            for (auto& arg : e->arguments) resolveExpr(arg, currentScope);
-        },
-        [&](const std::unique_ptr<BinaryExpr>& e) {
-            resolveExpr(e->left, currentScope);
-            resolveExpr(e->right, currentScope);
-        },
-        [&](std::unique_ptr<IfExpr>& s) {
-            resolveExpr(s->condition, currentScope);
-            resolveBlockExpr(*s->elseBranch, currentScope);
-            if (s->elseBranch) resolveBlockExpr(*s->elseBranch, currentScope);
-        },
-        [&](std::unique_ptr<WhileExpr>& s) {
-            resolveExpr(s->conditional, currentScope);
-            resolveBlockExpr(*s->body, currentScope);
-        },
-        [&](std::unique_ptr<BlockExpr>& s) { resolveBlockExpr(*s, currentScope); },
-        [](const auto&) { /* literals, variables — nothing to resolve */ }
-    }, expr);
+const FunctionInfo* Resolver::findFunction(const std::string& qualifiedName) {
+    return tryResolveFrom(splitByDot(qualifiedName), &root);
 }
 
-void Resolver::resolveBlockExpr(BlockExpr& e, Module* currentScope) {
-    // Make each scope a nameless module
-    // This will not be stored as a submodule in currentScope (Function scope will be inaccessible from outside)
-    auto functionModule = std::make_unique<Module>();
-    functionModule->parent = currentScope;
+bool Resolver::loadModule(Symbol name) {
+    if (!moduleLoader || root.submodules.count(name)) return false;
+
+    auto module = moduleLoader->load(name);
+    if (!module) return false;
+
+    registerStructs(*module);
+    layOutStructs();
+    registerStmt(*module, &root);
+    loadedModules.push_back(std::move(*module));
+    if (recording) {
+        undoLog.push_back([this, name] {
+            loadedModules.pop_back();
+            moduleLoader->forget(name);
+        });
+    }
 
-    for (auto& stmt: e.statements) resolveStmt(stmt, functionModule.get());
+    return true;
+}
 
-    if (e.tail) resolveExpr(**e.tail, currentScope);
+std::vector<Stmt> Resolver::takeLoadedModules() {
+    return std::exchange(loadedModules, {});
 }
 
-void Resolver::resolveStmt(Stmt& stmt, Module* currentScope) {
-    std::visit(overloaded{
-        [&](VarDeclStmt& s) { resolveExpr(s.value, currentScope); },
-        [&](ExprStmt& s) { resolveExpr(s.expression, currentScope); },
-        [&](ReturnStmt& s) { resolveExpr(s.value, currentScope); },
-        [&](std::unique_ptr<FunctionDecl>& s) {
-            resolveBlockExpr(*s->body, currentScope);
-        },
-        [&](std::unique_ptr<ModuleDecl>& s) {
-            Module* modPtr = currentScope->submodules[s->name].get();
-            for (auto& inner : s->body) resolveStmt(inner, modPtr);
-        },
-        [&](ImportStmt& s) {
-            if (s.wild_card) {
-                Module* mod = &root;
-                for (const auto& segment : s.path) {
-                    auto it = mod->submodules.find(segment);
-                    if (it == mod->submodules.end())
-                        throw std::runtime_error("Unknown module: " + segment);
-
-                    mod = it->second.get();
-                }
-
-                for (auto& [name, info] : mod->functions) {
-                    root.functions[name] = info;
-                }
-
-                return;
-            } 
-
-            bool is_module = true;
-            Module* mod = &root;
-            for (const auto& segment: s.path) {
-                auto it = mod->submodules.find(segment);
-                if (it != mod->submodules.end()) {
-                    mod = it->second.get();
-                    continue;
-                }
-                
-                is_module = false;
-                break;
-            }
+void Resolver::resolveImport(const ImportStmt& s) {
+    loadModule(s.path.front());
 
-            if (is_module) {
-                std::string alias = s.path.back();
-                root.aliases[alias] = mod;
-            } else {
-                const FunctionInfo* function = resolvePath(s.path, &root);
-                std::string alias = s.path.back();
-                root.functions[alias] = *function;
-            }
-        },
-        [](auto&) { /* BreakStmt, ContinueStmt */ }
-    }, stmt);
+    if (s.wild_card) {
+        Module* mod = &root;
+        for (const auto& segment : s.path) {
+            auto it = mod->submodules.find(segment);
+            if (it == mod->submodules.end())
+                throw std::runtime_error("Unknown module: " + symbolName(segment));
+
+            mod = it->second.get();
+        }
+
+        for (auto& [name, info] : mod->functions) {
+            setFunction(&root, name, info);
+        }
+
+        return;
+    } 
+
+    bool is_module = true;
+    Module* mod = &root;
+    for (const auto& segment: s.path) {
+        auto it = mod->submodules.find(segment);
+        if (it != mod->submodules.end()) {
+            mod = it->second.get();
+            continue;
+        }
+        
+        is_module = false;
+        break;
+    }
+
+    if (is_module) {
+        Symbol alias = s.path.back();
+        setAlias(alias, mod);
+    } else {
+        const FunctionInfo* function = resolvePath(s.path, &root);
+        Symbol alias = s.path.back();
+        setFunction(&root, alias, *function);
+    }
 }
 
-void Resolver::resolveProgram(std::vector<Stmt>& program) {
-    registerNativeModules();
-    registerUserDeclarations(program);
+Module* Resolver::submodule(Module* scope, Symbol name) {
+    return scope->submodules.at(name).get();
+}
 
-    if (!tryResolveFrom({"main"}, &root))
-        throw std::runtime_error("No main function found. Raft requires a starting point.");
+std::unordered_map<const void*, std::string> Resolver::functionNames() {
+    std::unordered_map<const void*, std::string> names;
+    collectFunctionNames(&root, "", names);
 
-    for (auto& stmt : program) {
-        resolveStmt(stmt, &root);
+    return names;
+}
+
+void Resolver::collectFunctionNames(Module* mod, const std::string& prefix, std::unordered_map<const void*, std::string>& names) {
+    // Submodules first: imports copy functions into the root, but the name they were declared under wins
+    for (auto& [name, sub] : mod->submodules) {
+        collectFunctionNames(sub.get(), prefix + symbolName(name) + ".", names);
     }
+
+    for (auto& [name, info] : mod->functions) {
+        if (!info.decl) {
+            names.emplace(info.native_def, prefix + symbolName(name));
+            continue;
+        }
+
+        // User functions say where they are declared, e.g. "fib (main.rft:8:1)"
+        std::string where = describePosition(info.decl->pos);
+        names.emplace(info.decl, prefix + symbolName(name) + (where.empty() ? "" : " (" + where + ")"));
+    }
+}
+
+void Resolver::declareProgram(std::vector<Stmt>& program) {
+    declare(program);
+
+    if (!tryResolveFrom({intern("main")}, &root))
+        throw std::runtime_error("No main function found. Raft requires a starting point.");
 }
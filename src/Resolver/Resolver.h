@@ -1,34 +1,85 @@
 #pragma once
 
 #include "Module.h"
+#include "ModuleLoader.h"
 #include "AST/AST.h"
 
+// Builds the module tree (natives and user declarations) up front.
+// Call paths and imports are resolved against it by the TypeChecker during its single walk over the program.
 class Resolver {
 public:
-    void resolveProgram(std::vector<Stmt>& program);
+    Resolver() { registerNativeModules(); }
+
+    // Registers the program's declarations and requires a main function
+    void declareProgram(std::vector<Stmt>& program);
+
+    // Registers declarations only (used by the REPL, one input at a time)
+    void declare(std::vector<Stmt>& statements);
+
+    const FunctionInfo* resolvePath(const std::vector<Symbol>& nameParts, Module* currentScope);
+    void resolveImport(const ImportStmt&);
+
+    // Looks a function up by its dotted name from the root, without loading modules (std.bench at runtime)
+    const FunctionInfo* findFunction(const std::string& qualifiedName);
+
+    Module* submodule(Module* scope, Symbol name);
+    Module* rootModule() { return &root; }
+
+    // Lazy mode: sibling files are parsed the first time a call path or import names them
+    void setModuleLoader(ModuleLoader* loader) { moduleLoader = loader; }
+
+    // Modules loaded on demand since the last call; their bodies still need checking
+    std::vector<Stmt> takeLoadedModules();
+
+    // The type a struct name stands for, or Unknown; and the layout of a struct type
+    Type structNamed(Symbol name) const;
+    const StructLayout& layoutOf(Type structType) const { return *structs[structId(structType)]; }
+
+    // Qualified name ("my_file.sub_mod.sum") of every FunctionDecl and NativeFunctionDef in the tree
+    std::unordered_map<const void*, std::string> functionNames();
+
+    // Changes to the module tree after beginTransaction can be undone, so a REPL input that fails leaves no trace
+    void beginTransaction();
+    void commit();
+    void rollback();
 
 private:
     std::vector<NativeFunctionDef> nativeDefs = getAllNativeDefs();
-    std::unordered_map<std::string, FunctionSig> functionSigs;
-    
+
     Module root;
 
+    // Struct types by id. Layouts are computed once every struct a batch of declarations names is known
+    std::vector<std::unique_ptr<StructLayout>> structs;
+    std::unordered_map<Symbol, uint32_t> structIds;
+    std::unordered_map<const StructLayout*, const StructDecl*> pendingLayouts; // Declared, not laid out yet
+
+    ModuleLoader* moduleLoader = nullptr;
+    std::vector<Stmt> loadedModules;
+
+    bool recording = false;
+    std::vector<std::function<void()>> undoLog;
+
+    bool loadModule(Symbol name);
+
+    Module* ensureSubmodule(Module* scope, Symbol name);
+    void setFunction(Module* scope, Symbol name, const FunctionInfo& info);
+    void setAlias(Symbol name, Module* module);
+
     Type typeFromString(const std::string&);
     std::string typeToString(Type);
+    std::string signatureToString(const FunctionSig&);
 
-    std::string joinWithDots(const std::vector<std::string>&);
+    std::string joinWithDots(const std::vector<Symbol>&);
 
     void registerNativeModules();
-    void registerUserDeclarations(std::vector<Stmt>& program);
     void registerStmt(Stmt& stmt, Module* currentScope);
+    void registerStructs(const Stmt& stmt);
+    void layOutStructs();
+    void layOut(StructLayout&, std::vector<const StructLayout*>& visiting);
 
-    void resolveStmt(Stmt& stmt, Module* currentScope);
-    void resolveExpr(const Expr& expr, Module* currentScope);
-
-    void resolveBlockExpr(BlockExpr&, Module* currentScope);
+    const FunctionInfo* tryResolveFrom(const std::vector<Symbol>&, Module*);
 
-    const FunctionInfo* tryResolveFrom(const std::vector<std::string>&, Module*);
-    const FunctionInfo* resolvePath(const std::vector<std::string>& nameParts, Module* currentScope);
+    void collectFunctionNames(Module* mod, const std::string& prefix, std::unordered_map<const void*, std::string>& names);
 
-    static std::vector<std::string> splitByDot(const std::string& s);
-};
\ No newline at end of file
+    static std::vector<Symbol> splitByDot(const std::string& s);
+};
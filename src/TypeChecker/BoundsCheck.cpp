@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <variant>
+
+#include "TypeChecker/TypeChecker.h"
+
+// Bounds check elision. In a loop of the form
+//
+//     let var i = 0;
+//     while i < std.array.length(a) { ... a[i] ... i = i + 1; }
+//
+// every a[i] that runs before the body first assigns i is in bounds: the condition gives
+// i < length, and i never goes negative when it starts at a non-negative literal and is
+// only ever grown by one. Both i and a must be locals, which no call can reassign, and the
+// body must not reassign a (arrays never change length).
+//
+// A counted loop is simpler: in `for i in 0..std.array.length(a)` the counter can't be assigned,
+// so every a[i] in the body is in bounds as long as the body doesn't reassign a.
+
+template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
+template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
+
+namespace {
+    template<class Visit> void walk(const Stmt&, const Visit&);
+    template<class Visit> void walk(const Expr&, const Visit&);
+
+    template<class Visit> void walk(const BlockExpr& block, const Visit& visit) {
+        for (const auto& stmt : block.statements) walk(stmt, visit);
+        if (block.tail) walk(**block.tail, visit);
+    }
+
+    // Calls visit on every expression and statement inside the node, the node included.
+    // Function and module declarations have frames of their own and are not entered.
+    template<class Visit> void walk(const Expr& expr, const Visit& visit) {
+        visit(expr);
+
+        std::visit(overloaded {
+            [&](const std::unique_ptr<BinaryExpr>& e) { walk(e->left, visit); walk(e->right, visit); },
+            [&](const std::unique_ptr<UnaryExpr>& e) { walk(e->operand, visit); },
+            [&](const std::unique_ptr<CallExpr>& e) { for (const auto& arg : e->arguments) walk(arg, visit); },
+            [&](const std::unique_ptr<IfExpr>& e) {
+                walk(e->condition, visit);
+                walk(*e->thenBranch, visit);
+                if (e->elseBranch) walk(*e->elseBranch, visit);
+            },
+            [&](const std::unique_ptr<BlockExpr>& e) { walk(*e, visit); },
+            [&](const std::unique_ptr<WhileExpr>& e) { walk(e->conditional, visit); walk(*e->body, visit); },
+            [&](const std::unique_ptr<ForExpr>& e) {
+                walk(e->start, visit);
+                if (e->end) walk(*e->end, visit);
+                walk(*e->body, visit);
+            },
+            [&](const std::unique_ptr<LoopExpr>& e) { walk(*e->body, visit); },
+            [&](const std::unique_ptr<IndexExpr>& e) { walk(e->array, visit); walk(e->index, visit); },
+            [&](const std::unique_ptr<ArrayExpr>& e) {
+                for (const auto& element : e->elements) walk(element, visit);
+                if (e->count) walk(*e->count, visit);
+            },
+            [&](const std::unique_ptr<StructExpr>& e) { for (const auto& field : e->fields) walk(field.value, visit); },
+            [&](const std::unique_ptr<FieldExpr>& e) { walk(e->object, visit); },
+            [&](const std::unique_ptr<MapExpr>& e) {
+                for (const auto& entry : e->entries) { walk(entry.key, visit); walk(entry.value, visit); }
+            },
+            [](const auto&) {}
+        }, expr);
+    }
+
+    template<class Visit> void walk(const Stmt& stmt, const Visit& visit) {
+        visit(stmt);
+
+        std::visit(overloaded {
+            [&](const VarDeclStmt& s) { walk(s.value, visit); },
+            [&](const ExprStmt& s) { walk(s.expression, visit); },
+            [&](const AssignmentStmt& s) { walk(s.value, visit); },
+            [&](const IndexAssignStmt& s) { walk(s.index, visit); walk(s.value, visit); },
+            [&](const FieldAssignStmt& s) {
+                if (s.index) walk(*s.index, visit);
+                walk(s.value, visit);
+            },
+            [&](const ReturnStmt& s) { walk(s.value, visit); },
+            [](const auto&) {}
+        }, stmt);
+    }
+
+    bool isLocal(const Expr& expr, uint32_t slot) {
+        auto* var = std::get_if<VariableExpr>(&expr);
+        return var && !var->slot.global && var->slot.index == slot;
+    }
+
+    const VariableExpr* localVariable(const Expr& expr) {
+        auto* var = std::get_if<VariableExpr>(&expr);
+        return var && !var->slot.global ? var : nullptr;
+    }
+
+    // A literal a counter may be set to or grown by: non-negative and small enough not to overflow it
+    bool isSmallNonNegative(const Expr& expr) {
+        auto* literal = std::get_if<LiteralExpr>(&expr);
+        auto* value = literal ? std::get_if<int64_t>(&literal->val) : nullptr;
+
+        return value && *value >= 0 && *value <= (int64_t{1} << 32);
+    }
+
+    // i = literal, i = i + literal, i += literal, i++ or i /= literal
+    bool keepsNonNegative(const AssignmentStmt& s) {
+        if (s.op == TokenType::PLUS_EQUAL || s.op == TokenType::PLUS_PLUS || s.op == TokenType::DIV_EQUAL) return isSmallNonNegative(s.value);
+        if (s.op != TokenType::EQUAL) return false;
+        if (isSmallNonNegative(s.value)) return true;
+
+        auto* sum = std::get_if<std::unique_ptr<BinaryExpr>>(&s.value);
+        return sum && (*sum)->op == TokenType::PLUS && isLocal((*sum)->left, s.slot.index) && isSmallNonNegative((*sum)->right);
+    }
+
+    const AssignmentStmt* assignmentTo(const Stmt& stmt, uint32_t slot) {
+        auto* s = std::get_if<AssignmentStmt>(&stmt);
+        return s && !s->slot.global && s->slot.index == slot ? s : nullptr;
+    }
+
+    bool assigns(const Stmt& stmt, uint32_t slot) {
+        bool found = false;
+
+        walk(stmt, overloaded {
+            [&](const Stmt& s) { if (assignmentTo(s, slot)) found = true; },
+            [](const Expr&) {}
+        });
+
+        return found;
+    }
+
+    // Whether the statement can leave the counter in slot negative
+    bool breaksCounter(const Stmt& stmt, uint32_t slot) {
+        bool broken = false;
+
+        walk(stmt, overloaded {
+            [&](const Stmt& s) {
+                if (auto* assignment = assignmentTo(s, slot); assignment && !keepsNonNegative(*assignment)) broken = true;
+            },
+            [](const Expr&) {}
+        });
+
+        return broken;
+    }
+
+    bool breaksCounter(const BlockExpr& block, uint32_t slot) {
+        for (const auto& stmt : block.statements) if (breaksCounter(stmt, slot)) return true;
+        return false;
+    }
+
+    bool assigns(const BlockExpr& block, uint32_t slot) {
+        for (const auto& stmt : block.statements) if (assigns(stmt, slot)) return true;
+        return false;
+    }
+
+    // Clears the bounds checks of a[i], a[i] = v and a[i].field = v
+    auto elideIndexes(uint32_t a, uint32_t i) {
+        return overloaded {
+            [=](const Expr& expr) {
+                auto* index = std::get_if<std::unique_ptr<IndexExpr>>(&expr);
+                if (index && isLocal((*index)->array, a) && isLocal((*index)->index, i)) (*index)->checked = false;
+            },
+            [=](const Stmt& stmt) {
+                auto* store = std::get_if<IndexAssignStmt>(&stmt);
+                if (store && !store->slot.global && store->slot.index == a && isLocal(store->index, i)) store->checked = false;
+
+                auto* field = std::get_if<FieldAssignStmt>(&stmt);
+                if (field && field->index && !field->slot.global && field->slot.index == a && isLocal(*field->index, i)) field->checked = false;
+            }
+        };
+    }
+
+    const WhileExpr* loopOf(const Expr& expr) {
+        auto* loop = std::get_if<std::unique_ptr<WhileExpr>>(&expr);
+        return loop ? loop->get() : nullptr;
+    }
+
+    // std.array.length(a) for a local a
+    const VariableExpr* lengthOf(const Expr& expr) {
+        auto* call = std::get_if<std::unique_ptr<CallExpr>>(&expr);
+        if (!call || !(*call)->resolved || !(*call)->resolved->native_def) return nullptr;
+        if ((*call)->resolved->native_def->qualifiedName != "std.array.length") return nullptr;
+
+        return localVariable((*call)->arguments.front());
+    }
+}
+
+void TypeChecker::elideBoundsChecks(const BlockExpr& block) {
+    // Locals declared in this block that hold a non-negative int and only grow
+    std::vector<uint32_t> counters;
+
+    for (const auto& stmt : block.statements) {
+        if (auto* s = std::get_if<ExprStmt>(&stmt); s && loopOf(s->expression)) {
+            elideBoundsChecks(*loopOf(s->expression), counters);
+        }
+
+        std::erase_if(counters, [&](uint32_t slot) { return breaksCounter(stmt, slot); });
+
+        if (auto* s = std::get_if<VarDeclStmt>(&stmt); s && s->isMutable && !s->slot.global && isSmallNonNegative(s->value)) {
+            counters.push_back(s->slot.index);
+        }
+    }
+
+    if (block.tail && loopOf(**block.tail)) elideBoundsChecks(*loopOf(**block.tail), counters);
+}
+
+void TypeChecker::elideBoundsChecks(const WhileExpr& loop, const std::vector<uint32_t>& counters) {
+    auto* condition = std::get_if<std::unique_ptr<BinaryExpr>>(&loop.conditional);
+    if (!condition || (*condition)->op != TokenType::LESS) return;
+
+    const VariableExpr* counter = localVariable((*condition)->left);
+    const VariableExpr* array = lengthOf((*condition)->right);
+    if (!counter || !array) return;
+
+    uint32_t i = counter->slot.index;
+    uint32_t a = array->slot.index;
+
+    if (std::find(counters.begin(), counters.end(), i) == counters.end()) return;
+    if (breaksCounter(*loop.body, i) || assigns(*loop.body, a)) return;
+
+    auto elide = elideIndexes(a, i);
+
+    // Until the first statement that assigns i, the condition still holds
+    for (const auto& stmt : loop.body->statements) {
+        if (assigns(stmt, i)) return;
+        walk(stmt, elide);
+    }
+
+    if (loop.body->tail) walk(**loop.body->tail, elide);
+}
+
+void TypeChecker::elideBoundsChecks(const ForExpr& loop) {
+    if (!loop.end) return;
+
+    const VariableExpr* array = lengthOf(*loop.end);
+    if (!array || !isSmallNonNegative(loop.start) || assigns(*loop.body, array->slot.index)) return;
+
+    walk(*loop.body, elideIndexes(array->slot.index, loop.slot.index));
+}
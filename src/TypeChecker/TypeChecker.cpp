@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <variant>
 
 #include "TypeChecker/TypeChecker.h"
 #include "Resolver/Module.h"
+#include "Profiler/Phases.h"
 
 template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
 template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
@@ -15,8 +17,26 @@ Type TypeChecker::typeFromString(const std::string& s) {
     if (s == "double") return Type::Double;
     if (s == "bool") return Type::Bool;
     if (s == "string") return Type::String;
+    if (s == "int[]") return Type::IntArray;
+    if (s == "double[]") return Type::DoubleArray;
+    if (s == "bool[]") return Type::BoolArray;
+    if (s == "string[]") return Type::StringArray;
+    if (s == "Builder") return Type::Builder;
+    if (s == "File") return Type::File;
     if (s == "") return Type::Void;
 
+    if (s.starts_with("Map<") && s.ends_with(">")) {
+        size_t comma = s.find(", ");
+        Type map = mapOf(typeFromString(s.substr(4, comma - 4)), typeFromString(s.substr(comma + 2, s.size() - comma - 3)));
+        if (map == Type::Unknown) throw std::runtime_error("Maps take int or string keys and int, double, bool or string values, not " + s);
+
+        return map;
+    }
+
+    bool array = s.ends_with("[]");
+    Type element = resolver.structNamed(intern(array ? s.substr(0, s.size() - 2) : s));
+    if (element != Type::Unknown) return array ? arrayOf(element) : element;
+
     throw std::runtime_error("Unknown type: " + s);
 }
 
@@ -26,9 +46,28 @@ std::string TypeChecker::typeToString(Type t) {
         case Type::Double: return "double";
         case Type::Bool: return "bool";
         case Type::String: return "string";
+        case Type::IntArray: return "int[]";
+        case Type::DoubleArray: return "double[]";
+        case Type::BoolArray: return "bool[]";
+        case Type::StringArray: return "string[]";
+        case Type::AnyArray: return "array";
+        case Type::Number: return "int or double";
+        case Type::NumberArray: return "int[] or double[]";
+        case Type::AnyMap: return "map";
+        case Type::MapKey: return "key";
+        case Type::MapValue: return "value";
+        case Type::MapKeyArray: return "key[]";
+        case Type::MapValueArray: return "value[]";
+        case Type::Builder: return "Builder";
+        case Type::File: return "File";
         case Type::Void: return "void";
 
-        default: return "unknown";
+        default:
+            if (isMap(t)) return "Map<" + typeToString(mapKey(t)) + ", " + typeToString(mapValue(t)) + ">";
+            if (isStruct(t)) return symbolName(resolver.layoutOf(t).name);
+            if (isStructArray(t)) return symbolName(resolver.layoutOf(elementType(t)).name) + "[]";
+
+            return "unknown";
     }
 }
 
@@ -36,6 +75,67 @@ bool TypeChecker::isNumber(Type type) {
     return (type == Type::Int || type == Type::Double);
 }
 
+// Values of type `from` can be stored where `to` is expected: ints widen to doubles
+bool TypeChecker::isAssignable(Type to, Type from) {
+    return to == from || (to == Type::Double && from == Type::Int) || (to == Type::AnyArray && isArray(from)) ||
+           (to == Type::AnyMap && isMap(from));
+}
+
+// Replaces a generic parameter type with what it stands for, binding it on first use
+Type TypeChecker::bindNumber(Type expected, Type actual, Type& number) {
+    if (expected != Type::Number && expected != Type::NumberArray) return expected;
+
+    if (number == Type::Unknown) {
+        Type element = expected == Type::NumberArray ? elementType(actual) : actual;
+        if (!isNumber(element)) return expected; // Reported as a mismatch by the caller
+
+        number = element;
+    }
+
+    return expected == Type::NumberArray ? arrayOf(number) : number;
+}
+
+// The same for the map generics, which the call's map argument fixes
+Type TypeChecker::bindMap(Type expected, Type actual, Type& map) {
+    if (expected == Type::AnyMap && map == Type::Unknown && isMap(actual)) map = actual;
+    if (map == Type::Unknown) return expected;
+
+    switch (expected) {
+        case Type::MapKey: return mapKey(map);
+        case Type::MapValue: return mapValue(map);
+        case Type::MapKeyArray: return arrayOf(mapKey(map));
+        case Type::MapValueArray: return arrayOf(mapValue(map));
+
+        default: return expected;
+    }
+}
+
+ElementKind TypeChecker::elementKind(Type element) {
+    switch (element) {
+        case Type::Int: return ElementKind::Int;
+        case Type::Double: return ElementKind::Double;
+        case Type::Bool: return ElementKind::Bool;
+        case Type::String: return ElementKind::String;
+
+        default:
+            if (isStruct(element)) return ElementKind::Struct;
+
+            throw std::runtime_error("Arrays cannot hold " + typeToString(element) + " elements");
+    }
+}
+
+Type TypeChecker::fieldType(const StructLayout::Field& field) {
+    switch (field.kind) {
+        case ElementKind::Int: return Type::Int;
+        case ElementKind::Double: return Type::Double;
+        case ElementKind::Bool: return Type::Bool;
+        case ElementKind::Struct: return structType(field.layout->id);
+        case ElementKind::String: break;
+    }
+
+    return Type::Unknown;
+}
+
 bool TypeChecker::isRelational(TokenType op) {
     return (
         op == TokenType::GREATER ||
@@ -54,30 +154,95 @@ bool TypeChecker::isLogical(TokenType op) {
     );
 }
 
+// The operator a compound assignment applies: + for += and ++
+TokenType TypeChecker::arithmeticOf(TokenType compound) {
+    switch (compound) {
+        case TokenType::PLUS_EQUAL: case TokenType::PLUS_PLUS: return TokenType::PLUS;
+        case TokenType::MINUS_EQUAL: case TokenType::MINUS_MINUS: return TokenType::MINUS;
+        case TokenType::MUL_EQUAL: return TokenType::MUL;
+        case TokenType::DIV_EQUAL: return TokenType::DIV;
+
+        default: throw std::runtime_error("Fatal error: Invalid assignment operator");
+    }
+}
+
+SlotRef TypeChecker::declare(Symbol name, Type type, bool isMutable) {
+    if (scopeDepth == 0) {
+        SlotRef slot{ static_cast<uint32_t>(globals.size()), true };
+        globals.push_back(Variable{ name, type, isMutable, slot });
+        globalIndex[name] = slot.index;
+        programLayout.globalCount = static_cast<uint32_t>(globals.size());
+
+        return slot;
+    }
+
+    SlotRef slot{ static_cast<uint32_t>(locals.size()), false };
+    locals.push_back(Variable{ name, type, isMutable, slot });
+    if (locals.size() > *frameSize) *frameSize = static_cast<uint32_t>(locals.size());
+
+    return slot;
+}
+
+const Variable& TypeChecker::lookup(Symbol name) {
+    // Innermost declaration wins, so search the scope stack from the top
+    for (auto it = locals.rbegin(); it != locals.rend(); ++it) {
+        if (it->name == name) return *it;
+    }
+
+    if (auto it = globalIndex.find(name); it != globalIndex.end()) return globals[it->second];
+
+    throw std::runtime_error("Undefined variable: " + symbolName(name));
+}
+
 Type TypeChecker::checkBlockExpr(const BlockExpr& block) {
-    auto previous = currentTypes;
-    currentTypes = std::make_shared<TypeEnvironment>(previous);
+    // Slots of a finished block are reused by the blocks that follow it
+    size_t scopeStart = locals.size();
+    scopeDepth++;
 
     for (const auto& stmt : block.statements) checkStmt(stmt);
 
     Type resultType = block.tail.has_value() ? checkExpr(**block.tail) : Type::Void;
 
-    currentTypes = previous;
+    elideBoundsChecks(block);
+
+    scopeDepth--;
+    locals.resize(scopeStart);
     return resultType;
 }
 
+// Errors are prefixed with the position of the innermost node that has one
 Type TypeChecker::checkExpr(const Expr& expr) {
+    try {
+        return checkExprNode(expr);
+    } catch (const std::runtime_error&) {
+        rethrowAt(positionOf(expr));
+    }
+}
+
+void TypeChecker::checkStmt(const Stmt& stmt) {
+    try {
+        checkStmtNode(stmt);
+    } catch (const std::runtime_error&) {
+        rethrowAt(positionOf(stmt));
+    }
+}
+
+Type TypeChecker::checkExprNode(const Expr& expr) {
     return std::visit(overloaded {
         [](const LiteralExpr& e) -> Type {
             if (std::holds_alternative<std::string>(e.val)) return Type::String;
             if (std::holds_alternative<int64_t>(e.val)) return Type::Int;
-            if (std::holds_alternative<double>(e.val)) return Type::Int;
+            if (std::holds_alternative<double>(e.val)) return Type::Double;
             if (std::holds_alternative<bool>(e.val)) return Type::Bool;
 
             throw std::runtime_error("Fatal error: Unknown literal");
         },
         [&](const VariableExpr& e) -> Type {
-            return currentTypes->lookup(e.id);
+            const Variable& var = lookup(e.id);
+            e.slot = var.slot;
+            noteArrayUse(var, e.pos);
+
+            return var.type;
         },
 
         [&](const std::unique_ptr<IfExpr>& e) -> Type {
@@ -86,6 +251,8 @@ Type TypeChecker::checkExpr(const Expr& expr) {
                 throw std::runtime_error("If condition must be a boolean");
 
             Type thenType = checkBlockExpr(*e->thenBranch);
+            if (!e->elseBranch) return Type::Void; // Parser guarantees a lone then branch has no tail
+
             Type elseType = checkBlockExpr(*e->elseBranch);
 
             if (thenType != elseType)
@@ -108,6 +275,18 @@ Type TypeChecker::checkExpr(const Expr& expr) {
             return type;
         },
 
+        [&](const std::unique_ptr<ForExpr>& e) -> Type {
+            return checkForExpr(*e);
+        },
+
+        [&](const std::unique_ptr<LoopExpr>& e) -> Type {
+            loop_depth++;
+            checkBlockExpr(*e->body);
+            loop_depth--;
+
+            return Type::Void;
+        },
+
         [&](const std::unique_ptr<BlockExpr>& e) -> Type {
             return checkBlockExpr(*e);
         },
@@ -124,7 +303,23 @@ Type TypeChecker::checkExpr(const Expr& expr) {
             return checkUnaryOp(e->op, operandType);
         },
         [&](const std::unique_ptr<CallExpr>& e) -> Type {
-            if (!e->resolved) throw std::runtime_error("Internal error: unresolved function");
+            e->resolved = resolver.resolvePath(e->name_parts, currentModule);
+
+            if (const FunctionDecl* callee = e->resolved->decl) {
+                if (currentEffects) currentEffects->calls.push_back(callee);
+                if (parallelLoop) parallelCalls.push_back(ParallelCall{ callee, e->pos });
+            }
+
+            if (const NativeFunctionDef* native = e->resolved->native_def; native && native->changesArgument) {
+                if (parallelLoop) throw std::runtime_error("A par for body cannot call " + native->qualifiedName + ", which changes its argument");
+                if (currentEffects) currentEffects->writesShared = true;
+            }
+
+            // The function it runs could do anything a par for can't allow
+            if (const NativeFunctionDef* native = e->resolved->native_def; native && native->callsByName) {
+                if (parallelLoop) throw std::runtime_error("A par for body cannot call " + native->qualifiedName + ", which calls a function by name");
+                if (currentEffects) currentEffects->writesShared = true;
+            }
 
             const auto& sig = e->resolved->signature;
 
@@ -138,24 +333,352 @@ Type TypeChecker::checkExpr(const Expr& expr) {
             if (e->arguments.size() != sig.params.size())
                 throw std::runtime_error("Wrong number of arguments"); // Implement notation
 
+            Type number = Type::Unknown; // What Number stands for in this call
+            Type map = Type::Unknown;    // The type of the map argument
+
             for (size_t i = 0; i < e->arguments.size(); ++i) {
                 Type argType = checkExpr(e->arguments[i]);
 
-                Type expected = sig.params[i];
+                Type expected = bindMap(bindNumber(sig.params[i], argType, number), argType, map);
 
-                if (argType != expected && !(expected == Type::Double && argType == Type::Int)) {
+                if (!isAssignable(expected, argType)) {
                     throw std::runtime_error(
                         "Argument " + std::to_string(i + 1) + " of call to " + // Implement notation
                         ": expected " + typeToString(expected) + ", got " + typeToString(argType));
                 }
             }
 
-            return e->resolved->signature.return_type;
+            Type result = e->resolved->signature.return_type;
+            if (result == Type::Number) return number;
+            if (result == Type::NumberArray) return arrayOf(number);
+
+            return bindMap(result, Type::Unknown, map);
+        },
+
+        [&](const std::unique_ptr<IndexExpr>& e) -> Type {
+            size_t outerReads = parallelLoop ? parallelLoop->reads.size() : 0;
+
+            Type arrayType = checkExpr(e->array);
+            if (!isArray(arrayType)) throw std::runtime_error("Only arrays can be indexed, not " + typeToString(arrayType));
+
+            if (checkExpr(e->index) != Type::Int) throw std::runtime_error("Array index must be an int");
+
+            // Each iteration of a par for may read its own element of an outer array
+            bool ownElement = parallelLoop && std::holds_alternative<VariableExpr>(e->array) && isCounter(e->index);
+            if (ownElement && parallelLoop->reads.size() > outerReads) parallelLoop->reads.pop_back();
+
+            return elementType(arrayType);
+        },
+
+        [&](const std::unique_ptr<ArrayExpr>& e) -> Type {
+            // Elements share one type; ints mixed with doubles make a double array
+            Type element = checkExpr(e->elements.front());
+
+            for (size_t i = 1; i < e->elements.size(); i++) {
+                Type next = checkExpr(e->elements[i]);
+
+                if (isAssignable(element, next)) continue;
+                if (isAssignable(next, element)) { element = next; continue; }
+
+                throw std::runtime_error("Array elements must have one type: found " + typeToString(element) + " and " + typeToString(next));
+            }
+
+            Type array = arrayOf(element);
+            if (array == Type::Unknown) throw std::runtime_error("Arrays cannot hold " + typeToString(element) + " elements");
+
+            if (e->count && checkExpr(*e->count) != Type::Int) throw std::runtime_error("Array length must be an int");
+
+            e->kind = elementKind(element);
+            return array;
+        },
+
+        [&](const std::unique_ptr<StructExpr>& e) -> Type {
+            Type type = resolver.structNamed(e->name);
+            if (!isStruct(type)) throw std::runtime_error("Unknown struct: " + symbolName(e->name));
+
+            const StructLayout& layout = resolver.layoutOf(type);
+            e->layout = &layout;
+
+            for (size_t i = 0; i < e->fields.size(); i++) {
+                const auto& init = e->fields[i];
+                std::string name = symbolName(init.name);
+
+                init.resolved = layout.field(init.name);
+                if (!init.resolved) throw std::runtime_error("Struct " + typeToString(type) + " has no field " + name);
+
+                for (size_t j = 0; j < i; j++) {
+                    if (e->fields[j].name == init.name) throw std::runtime_error("Field " + name + " is given twice");
+                }
+
+                Type expected = fieldType(*init.resolved);
+                Type actual = checkExpr(init.value);
+
+                if (!isAssignable(expected, actual)) {
+                    throw std::runtime_error(
+                        "Field type mismatch: " + typeToString(type) + "." + name + " is " + typeToString(expected) + ", not " + typeToString(actual));
+                }
+            }
+
+            if (e->fields.size() != layout.fields.size()) {
+                for (const auto& field : layout.fields) {
+                    bool given = std::any_of(e->fields.begin(), e->fields.end(), [&](const auto& init) { return init.name == field.name; });
+                    if (!given) throw std::runtime_error("Missing field " + symbolName(field.name) + " of " + typeToString(type));
+                }
+            }
+
+            return type;
+        },
+
+        [&](const std::unique_ptr<FieldExpr>& e) -> Type {
+            Type type = checkExpr(e->object);
+            if (!isStruct(type)) throw std::runtime_error("Only structs have fields, not " + typeToString(type));
+
+            e->resolved = resolver.layoutOf(type).field(e->field);
+            if (!e->resolved) throw std::runtime_error("Struct " + typeToString(type) + " has no field " + symbolName(e->field));
+
+            return fieldType(*e->resolved);
+        },
+
+        [&](const std::unique_ptr<MapExpr>& e) -> Type {
+            Type map = typeFromString(e->type);
+            Type key = mapKey(map);
+            Type value = mapValue(map);
+
+            for (const auto& entry : e->entries) {
+                Type keyType = checkExpr(entry.key);
+                if (keyType != key) throw std::runtime_error("Keys of a " + typeToString(map) + " must be " + typeToString(key) + ", not " + typeToString(keyType));
+
+                Type valueType = checkExpr(entry.value);
+                if (!isAssignable(value, valueType))
+                    throw std::runtime_error("Values of a " + typeToString(map) + " must be " + typeToString(value) + ", not " + typeToString(valueType));
+            }
+
+            e->keyKind = elementKind(key);
+            e->valueKind = elementKind(value);
+            return map;
         }
     }, expr);
 }
 
+Type TypeChecker::checkForExpr(const ForExpr& e) {
+    Type counterType = Type::Int;
+
+    if (e.end) {
+        if (checkExpr(e.start) != Type::Int || checkExpr(*e.end) != Type::Int)
+            throw std::runtime_error("Range bounds of a for loop must be ints");
+    } else {
+        Type source = checkExpr(e.start);
+        if (!isArray(source)) throw std::runtime_error("A for loop goes over a range a..b or an array, not " + typeToString(source));
+
+        counterType = elementType(source);
+    }
+
+    // The counter gets a scope of its own around the body, and is always a local
+    size_t scopeStart = locals.size();
+    scopeDepth++;
+    e.slot = declare(e.name, counterType, false);
+
+    std::optional<ParallelLoop> outerParallelLoop;
+    if (e.parallel) {
+        outerParallelLoop = std::move(parallelLoop);
+        parallelLoop = ParallelLoop{ scopeStart, e.slot.index, e.end != nullptr, loop_depth + 1, parallelCalls.size() };
+    }
+
+    loop_depth++;
+    Type bodyType = checkBlockExpr(*e.body);
+    loop_depth--;
+
+    if (e.parallel) {
+        ParallelLoop loop = std::move(*parallelLoop);
+        parallelLoop = std::move(outerParallelLoop);
+        checkOuterReads(loop);
+    }
+
+    scopeDepth--;
+    locals.resize(scopeStart);
+
+    elideBoundsChecks(e);
+    if (e.reduce == ReduceOp::None) return Type::Void;
+
+    if (!isNumber(bodyType))
+        throw std::runtime_error("The body of a reducing par for must end in an int or double, not " + typeToString(bodyType));
+
+    e.reducesDoubles = bodyType == Type::Double;
+    return bodyType;
+}
+
+bool TypeChecker::isCounter(const Expr& index) {
+    auto* counter = std::get_if<VariableExpr>(&index);
+    return parallelLoop->counted && counter && !counter->slot.global && counter->slot.index == parallelLoop->counter;
+}
+
+// Stores into a variable declared outside a par for would race with the other iterations. Each
+// iteration may still fill its own element of an outer array: a[i] = v with i the counter.
+void TypeChecker::checkOuterWrite(const Variable& var, const Expr* index) {
+    if (var.slot.global && currentEffects) currentEffects->writesShared = true;
+
+    if (!parallelLoop) return;
+    if (!var.slot.global && var.slot.index >= parallelLoop->outerLocals) return;
+
+    std::string name = symbolName(var.name);
+    if (!index) {
+        throw std::runtime_error(
+            "A par for body cannot assign '" + name + "', which is declared outside the loop; use reduce to combine values");
+    }
+
+    if (!isCounter(*index)) {
+        throw std::runtime_error(
+            "A par for body can only store into '" + name + "', which is declared outside the loop, at the loop counter");
+    }
+
+    parallelLoop->stores.push_back(OuterArrayUse{ var.name, var.slot, positionOf(*index) });
+}
+
+// Arrays named in a par for body or a function, for checkOuterReads and checkParallelCalls
+void TypeChecker::noteArrayUse(const Variable& var, SourcePos pos) {
+    if (!isArray(var.type)) return;
+
+    if (var.slot.global && currentEffects) currentEffects->globalArrays.insert(var.slot.index);
+
+    if (parallelLoop && (var.slot.global || var.slot.index < parallelLoop->outerLocals)) {
+        parallelLoop->reads.push_back(OuterArrayUse{ var.name, var.slot, pos });
+    }
+}
+
+// An element one iteration stores into can't be read by another: a par for body that stores into
+// an outer array may only read it at the loop counter, and only call functions that leave it alone.
+// A par for nested in another one is part of its body, so what it names is passed on to the outer loop.
+void TypeChecker::checkOuterReads(ParallelLoop& loop) {
+    auto sameSlot = [](const OuterArrayUse& a, const OuterArrayUse& b) {
+        return a.slot.global == b.slot.global && a.slot.index == b.slot.index;
+    };
+
+    for (const auto& read : loop.reads) {
+        if (std::none_of(loop.stores.begin(), loop.stores.end(), [&](const auto& store) { return sameSlot(read, store); })) continue;
+
+        try {
+            throw std::runtime_error(
+                "A par for body that stores into '" + symbolName(read.name) + "' can only read it at the loop counter");
+        } catch (const std::runtime_error&) {
+            rethrowAt(read.pos);
+        }
+    }
+
+    for (size_t i = loop.firstCall; i < parallelCalls.size(); i++) {
+        for (const auto& store : loop.stores) {
+            if (store.slot.global) parallelCalls[i].storedGlobals.push_back(store.slot.index);
+        }
+    }
+
+    if (!parallelLoop) return;
+
+    auto declaredOutside = [&](const OuterArrayUse& use) { return use.slot.global || use.slot.index < parallelLoop->outerLocals; };
+
+    for (const auto& store : loop.stores) {
+        if (!declaredOutside(store)) continue;
+
+        try {
+            throw std::runtime_error(
+                "A par for body can only store into '" + symbolName(store.name) + "', which is declared outside the loop, at the loop counter");
+        } catch (const std::runtime_error&) {
+            rethrowAt(store.pos);
+        }
+    }
+
+    for (auto& read : loop.reads) {
+        if (declaredOutside(read)) parallelLoop->reads.push_back(std::move(read));
+    }
+}
+
+// Natives always return arrays of their own making
+bool TypeChecker::makesNewArray(const Expr& value) {
+    if (std::holds_alternative<std::unique_ptr<ArrayExpr>>(value)) return true;
+
+    auto* call = std::get_if<std::unique_ptr<CallExpr>>(&value);
+    return call && (*call)->resolved && (*call)->resolved->native_def;
+}
+
+// Arrays are shared by reference, so a let var bound to an existing array can store into it under
+// another name. In a par for body that could be an array declared outside the loop, and in a
+// function one of its caller's; only new arrays may be bound there.
+void TypeChecker::checkArrayBinding(Type type, const Expr& value) {
+    if (!isArray(type) || makesNewArray(value)) return;
+
+    if (parallelLoop) {
+        throw std::runtime_error(
+            "A par for body can only bind a let var array to a new array (an array literal or the result of a std function)");
+    }
+
+    if (currentEffects) currentEffects->writesShared = true;
+}
+
+bool TypeChecker::writesShared(const FunctionDecl* fn, std::unordered_set<const FunctionDecl*>& visited) {
+    if (!visited.insert(fn).second) return false;
+
+    auto it = effects.find(fn);
+    if (it == effects.end()) return false;
+    if (it->second.writesShared) return true;
+
+    for (const FunctionDecl* callee : it->second.calls) {
+        if (writesShared(callee, visited)) return true;
+    }
+
+    return false;
+}
+
+// The first of slots that fn or a function it calls names
+const uint32_t* TypeChecker::readsGlobal(const FunctionDecl* fn, const std::vector<uint32_t>& slots, std::unordered_set<const FunctionDecl*>& visited) {
+    if (!visited.insert(fn).second) return nullptr;
+
+    auto it = effects.find(fn);
+    if (it == effects.end()) return nullptr;
+
+    for (const uint32_t& slot : slots) {
+        if (it->second.globalArrays.count(slot)) return &slot;
+    }
+
+    for (const FunctionDecl* callee : it->second.calls) {
+        if (const uint32_t* slot = readsGlobal(callee, slots, visited)) return slot;
+    }
+
+    return nullptr;
+}
+
+// Every thread of a par for shares the globals, maps, builders, files and outer arrays, so the functions it calls must leave them alone
+void TypeChecker::checkParallelCalls() {
+    auto calls = std::move(parallelCalls);
+    parallelCalls.clear();
+
+    for (const auto& call : calls) {
+        std::unordered_set<const FunctionDecl*> visited;
+        if (writesShared(call.fn, visited)) {
+            try {
+                throw std::runtime_error(
+                    "A par for body cannot call '" + symbolName(call.fn->name) + "', which can assign global variables, store into arrays it did not create or change maps, builders and files");
+            } catch (const std::runtime_error&) {
+                rethrowAt(call.pos);
+            }
+        }
+
+        visited.clear();
+        if (const uint32_t* slot = readsGlobal(call.fn, call.storedGlobals, visited)) {
+            try {
+                throw std::runtime_error(
+                    "A par for body cannot call '" + symbolName(call.fn->name) + "', which reads '" + symbolName(globals[*slot].name) + "' while the loop stores into it");
+            } catch (const std::runtime_error&) {
+                rethrowAt(call.pos);
+            }
+        }
+    }
+}
+
 Type TypeChecker::checkBinaryOp(TokenType op, Type left, Type right) {
+    if (isArray(left) || isArray(right)) throw std::runtime_error("Operators are not supported for arrays");
+    if (isStruct(left) || isStruct(right)) throw std::runtime_error("Operators are not supported for structs");
+    if (isMap(left) || isMap(right)) throw std::runtime_error("Operators are not supported for maps");
+    if (left == Type::Builder || right == Type::Builder) throw std::runtime_error("Operators are not supported for builders");
+    if (left == Type::File || right == Type::File) throw std::runtime_error("Operators are not supported for files");
+
     if (left == Type::String) {
         if (right != Type::String) throw std::runtime_error("Invalid: RHS must be string");
 
@@ -203,7 +726,7 @@ Type TypeChecker::checkUnaryOp(TokenType op, Type operand) {
     throw std::runtime_error("Fatal error: Invalid operator");
 }
 
-void TypeChecker::checkStmt(const Stmt& stmt) {
+void TypeChecker::checkStmtNode(const Stmt& stmt) {
     std::visit(overloaded{
         [&](const VarDeclStmt& s) {
             Type initType = checkExpr(s.value);
@@ -211,56 +734,146 @@ void TypeChecker::checkStmt(const Stmt& stmt) {
 
             if ((annotatedType != Type::Void) && (initType != annotatedType)) {
                 if (initType == Type::Int && annotatedType == Type::Double) {
-                    currentTypes->define(s.name, Type::Double);
+                    s.slot = declare(s.name, Type::Double, s.isMutable);
                     return;
                 }
 
                 throw std::runtime_error("Declaration type is not compatible with annotated type");
             }
 
-            currentTypes->define(s.name, initType);
+            if (s.isMutable) checkArrayBinding(initType, s.value);
+            s.slot = declare(s.name, initType, s.isMutable);
         },
 
         [&](const AssignmentStmt& s) {
-            Type expected = currentTypes->lookup(s.id);
+            const Variable& var = lookup(s.id);
+            if (!var.isMutable) throw std::runtime_error(symbolName(s.id) + " is not a mutable value");
+
+            Type expected = var.type;
+            s.slot = var.slot;
+            checkOuterWrite(var, nullptr);
+
             Type actual = checkExpr(s.value);
+            checkArrayBinding(expected, s.value);
+
+            // x op= value is x = x op value, which has to leave x's type as it was
+            if (s.op != TokenType::EQUAL) {
+                if (s.op == TokenType::PLUS_PLUS || s.op == TokenType::MINUS_MINUS) {
+                    if (!isNumber(expected)) throw std::runtime_error("++ and -- need an int or double variable, not " + typeToString(expected));
+                } else if (!isNumber(expected) && expected != Type::String) {
+                    throw std::runtime_error("Compound assignment needs an int, double or string variable, not " + typeToString(expected));
+                }
+
+                actual = checkBinaryOp(arithmeticOf(s.op), expected, actual);
+                s.kind = elementKind(expected);
+            }
 
             if (actual != expected) {
                 if (!(expected == Type::Double && actual == Type::Int)) {
                     throw std::runtime_error(
-                        "Assignment type mismatch: \'" + s.id + "\' defined as " + typeToString(expected) +
+                        "Assignment type mismatch: \'" + symbolName(s.id) + "\' defined as " + typeToString(expected) +
                         " but being assigned to " + typeToString(actual));
                 }
             }
         },
 
+        [&](const IndexAssignStmt& s) {
+            const Variable& var = lookup(s.id);
+            if (!var.isMutable) throw std::runtime_error(symbolName(s.id) + " is not a mutable value");
+            if (!isArray(var.type)) throw std::runtime_error("Only arrays can be indexed, not " + typeToString(var.type));
+
+            s.slot = var.slot;
+
+            if (checkExpr(s.index) != Type::Int) throw std::runtime_error("Array index must be an int");
+            checkOuterWrite(var, &s.index);
+
+            Type element = elementType(var.type);
+            Type actual = checkExpr(s.value);
+
+            if (!isAssignable(element, actual)) {
+                throw std::runtime_error(
+                    "Element type mismatch: \'" + symbolName(s.id) + "\' holds " + typeToString(element) +
+                    " but is being assigned " + typeToString(actual));
+            }
+        },
+
+        [&](const FieldAssignStmt& s) {
+            const Variable& var = lookup(s.id);
+            if (!var.isMutable) throw std::runtime_error(symbolName(s.id) + " is not a mutable value");
+
+            s.slot = var.slot;
+            Type type = var.type;
+
+            if (s.index) {
+                if (!isStructArray(type)) throw std::runtime_error("Only arrays of structs have elements with fields, not " + typeToString(type));
+                if (checkExpr(*s.index) != Type::Int) throw std::runtime_error("Array index must be an int");
+
+                type = elementType(type);
+            }
+
+            checkOuterWrite(var, s.index.get());
+
+            // Nested fields sit inside their struct, so the offsets add up to one
+            s.offset = 0;
+            for (Symbol name : s.fields) {
+                if (!isStruct(type)) throw std::runtime_error("Only structs have fields, not " + typeToString(type));
+
+                s.resolved = resolver.layoutOf(type).field(name);
+                if (!s.resolved) throw std::runtime_error("Struct " + typeToString(type) + " has no field " + symbolName(name));
+
+                s.offset += s.resolved->offset;
+                type = fieldType(*s.resolved);
+            }
+
+            Type actual = checkExpr(s.value);
+            if (!isAssignable(type, actual)) {
+                throw std::runtime_error(
+                    "Field type mismatch: the field is " + typeToString(type) + " but is being assigned " + typeToString(actual));
+            }
+        },
+
+        [&](const std::unique_ptr<StructDecl>&) {}, // Laid out by the Resolver
+
         [&](const ExprStmt& s) {
             checkExpr(s.expression);
         },
         
         [&](const std::unique_ptr<FunctionDecl>& s) {
-            auto previous = currentTypes;
+            // Functions only see globals, so they start from an empty scope stack
+            auto previousLocals = std::move(locals);
+            auto previousFrameSize = frameSize;
+            auto previousDepth = scopeDepth;
 
-            currentTypes = std::make_shared<TypeEnvironment>(globalTypes);
+            locals.clear();
+            s->frameSize = 0;
+            frameSize = &s->frameSize;
+            scopeDepth = 1;
 
             for (const auto& param : s->params) {
-                currentTypes->define(param.name, typeFromString(param.type));
-            }  
+                declare(param.name, typeFromString(param.type), false);
+            }
 
             auto previousExpectedReturn = currentExpectedReturn;
             currentExpectedReturn = typeFromString(s->returnType);
-            
-            // Note to Self: Implemented this seperately instead of just passing body to checkStmt
-            // because we want to capture the globalEnv instead of the previous environment
-            for (const auto& statement: s->body->statements) {
-                checkStmt(statement);
-            }
 
+            auto previousParallelLoop = parallelLoop;
+            auto previousEffects = currentEffects;
+            parallelLoop.reset();
+            currentEffects = &effects[s.get()];
+
+            checkBlockExpr(*s->body);
+
+            parallelLoop = previousParallelLoop;
+            currentEffects = previousEffects;
             currentExpectedReturn = previousExpectedReturn;
-            currentTypes = previous;
+            scopeDepth = previousDepth;
+            frameSize = previousFrameSize;
+            locals = std::move(previousLocals);
         },
 
         [&](const ReturnStmt& s) {
+            if (parallelLoop) throw std::runtime_error("Cannot return from inside a par for");
+
             Type actual = checkExpr(s.value);
 
             if (actual != currentExpectedReturn) {
@@ -274,6 +887,7 @@ void TypeChecker::checkStmt(const Stmt& stmt) {
 
         [&](const BreakStmt& s) {
             if (loop_depth == 0) throw std::runtime_error("Used break outside a loop");
+            if (parallelLoop && loop_depth == parallelLoop->loopDepth) throw std::runtime_error("Cannot break out of a par for");
         },
 
         [&](const ContinueStmt& s) {
@@ -281,13 +895,69 @@ void TypeChecker::checkStmt(const Stmt& stmt) {
         },
 
         [&](const std::unique_ptr<ModuleDecl>& s) {
+            Module* previous = currentModule;
+            currentModule = resolver.submodule(currentModule, s->name);
+
             for (auto const& stmt: s->body)
                 checkStmt(stmt);
+
+            currentModule = previous;
         },
 
         [&](const ImportStmt& s) {
-            // Nothing to do here as resolver has already handled
+            resolver.resolveImport(s);
         }
 
     }, stmt);
-}
\ No newline at end of file
+}
+
+void TypeChecker::checkProgram(std::vector<Stmt>& program) {
+    // Top level modules are the sibling files, so they are timed one by one
+    auto checkTopLevelStmt = [&](const Stmt& stmt) {
+        if (auto* mod = std::get_if<std::unique_ptr<ModuleDecl>>(&stmt)) {
+            PhaseScope phase("check " + symbolName((*mod)->name));
+            checkStmt(stmt);
+            return;
+        }
+
+        checkStmt(stmt);
+    };
+
+    for (const auto& stmt : program) checkTopLevelStmt(stmt);
+
+    // Checking a lazily loaded module can pull in further modules
+    for (auto loaded = resolver.takeLoadedModules(); !loaded.empty(); loaded = resolver.takeLoadedModules()) {
+        for (auto& stmt : loaded) {
+            checkTopLevelStmt(stmt);
+            program.push_back(std::move(stmt));
+        }
+    }
+
+    checkParallelCalls();
+}
+
+Type TypeChecker::checkTopLevel(const BlockExpr& block) {
+    Type type = checkBlockExpr(block);
+    checkParallelCalls();
+
+    return type;
+}
+
+void TypeChecker::rollback(size_t checkpoint) {
+    globals.resize(checkpoint);
+
+    globalIndex.clear();
+    for (const auto& var : globals) globalIndex[var.name] = var.slot.index;
+    programLayout.globalCount = static_cast<uint32_t>(globals.size());
+
+    // A failure can leave the walk anywhere, so return to the top level
+    locals.clear();
+    scopeDepth = 0;
+    loop_depth = 0;
+    frameSize = &programLayout.initFrameSize;
+    currentModule = resolver.rootModule();
+    currentExpectedReturn = Type::Void;
+    parallelLoop.reset();
+    currentEffects = nullptr;
+    parallelCalls.clear();
+}
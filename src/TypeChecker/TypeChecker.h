@@ -1,36 +1,37 @@
 #pragma once
 
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "Parser/parser.h"
 #include "AST/AST.h"
 #include "Util/token.h"
 #include "Resolver/Module.h"
+#include "Resolver/Resolver.h"
 
-class TypeEnvironment {
-public:
-    explicit TypeEnvironment(std::shared_ptr<TypeEnvironment> parent = nullptr)
-        : parent(std::move(parent)) {}
-
-    void define(const std::string& name, Type type) {
-        types[name] = type;
-    }
-
-    Type lookup(const std::string& name) {
-        if (auto it = types.find(name); it != types.end()) return it->second;
-        if (parent) return parent->lookup(name);
-        throw std::runtime_error("Undefined variable: " + name);
-    }
+// Storage the Interpreter needs to reserve for a checked program
+struct ProgramLayout {
+    uint32_t globalCount = 0;
+    uint32_t initFrameSize = 0; // Locals used by blocks inside top level initializers
+};
 
-private:
-    std::unordered_map<std::string, Type> types;
-    std::shared_ptr<TypeEnvironment> parent;
+struct Variable {
+    Symbol name;
+    Type type;
+    bool isMutable;
+    SlotRef slot;
 };
 
+// Single semantic pass over the program: resolves calls through the Resolver's module tree,
+// computes types and assigns every variable a slot.
 class TypeChecker {
 public:
-    TypeChecker() : globalTypes(std::make_shared<TypeEnvironment>()), currentTypes(globalTypes) {}
+    explicit TypeChecker(Resolver& resolver) : resolver(resolver), currentModule(resolver.rootModule()) {}
+
+    // Modules the Resolver loads on demand are checked last and appended to the program
+    void checkProgram(std::vector<Stmt>&);
 
     Type checkExpr(const Expr&);
     Type checkBinaryOp(TokenType, Type, Type);
@@ -38,22 +39,106 @@ public:
 
     void checkStmt(const Stmt&);
 
+    // Checks code outside any function (a REPL input); its block locals use the init frame
+    Type checkTopLevel(const BlockExpr&);
+
+    const ProgramLayout& layout() const { return programLayout; }
+
+    // Lets the REPL discard the globals declared by an input that failed
+    size_t checkpoint() const { return globals.size(); }
+    void rollback(size_t checkpoint);
+
 private:
-    std::shared_ptr<TypeEnvironment> globalTypes;
-    std::shared_ptr<TypeEnvironment> currentTypes;
+    Resolver& resolver;
+    Module* currentModule;
+
+    // Scopes are a stack of the current function's locals; a block remembers the height it started at
+    std::vector<Variable> locals;
+    std::vector<Variable> globals;
+    std::unordered_map<Symbol, uint32_t> globalIndex;
+
+    int scopeDepth = 0;
+    uint32_t* frameSize = &programLayout.initFrameSize; // High-water mark of locals for the frame being checked
+    ProgramLayout programLayout;
 
     Type currentExpectedReturn = Type::Void;
 
+    SlotRef declare(Symbol name, Type type, bool isMutable);
+    const Variable& lookup(Symbol name);
+
     Type typeFromString(const std::string&);
     std::string typeToString(Type);
 
     bool isNumber(Type type);
+    bool isAssignable(Type to, Type from);
+    Type bindNumber(Type expected, Type actual, Type& number);
+    Type bindMap(Type expected, Type actual, Type& map);
+    ElementKind elementKind(Type element);
+    Type fieldType(const StructLayout::Field&);
 
     bool isRelational(TokenType op);
 
     bool isLogical(TokenType op);
 
+    TokenType arithmeticOf(TokenType compound);
+
     Type checkBlockExpr(const BlockExpr&);
 
+    // Bounds check elision for loops over arrays (BoundsCheck.cpp)
+    void elideBoundsChecks(const BlockExpr&);
+    void elideBoundsChecks(const WhileExpr&, const std::vector<uint32_t>& counters);
+    void elideBoundsChecks(const ForExpr&);
+    Type checkExprNode(const Expr&);
+    void checkStmtNode(const Stmt&);
+
     int loop_depth = 0;
-};
\ No newline at end of file
+
+    // An array declared outside a par for, named in its body
+    struct OuterArrayUse {
+        Symbol name;
+        SlotRef slot;
+        SourcePos pos;
+    };
+
+    // The innermost par for being checked. Its iterations run at the same time, so its body may
+    // not assign what is declared outside it, nor leave it with break or return.
+    struct ParallelLoop {
+        size_t outerLocals;   // Locals below this are declared outside the loop
+        uint32_t counter;     // Outer arrays may be stored into at this index only
+        bool counted;         // False for an element loop, which has no index
+        int loopDepth;        // loop_depth of its body
+        size_t firstCall;     // parallelCalls from here on are made in its body
+
+        std::vector<OuterArrayUse> stores; // Stored into at the counter
+        std::vector<OuterArrayUse> reads;  // Used other than at the counter
+    };
+    std::optional<ParallelLoop> parallelLoop;
+
+    // What a function's body does that a par for can't allow. Bodies may be checked after the
+    // loops that call them, so calls from par for loops are checked once the program is.
+    struct FunctionEffects {
+        bool writesShared = false; // Assigns globals, binds an existing array to a let var, or changes a map, builder or file
+        std::unordered_set<uint32_t> globalArrays; // Global arrays it names
+        std::vector<const FunctionDecl*> calls;
+    };
+    std::unordered_map<const FunctionDecl*, FunctionEffects> effects;
+    FunctionEffects* currentEffects = nullptr;
+
+    struct ParallelCall {
+        const FunctionDecl* fn;
+        SourcePos pos;
+        std::vector<uint32_t> storedGlobals; // Global arrays the loop stores into
+    };
+    std::vector<ParallelCall> parallelCalls;
+
+    Type checkForExpr(const ForExpr&);
+    bool isCounter(const Expr&);
+    void checkOuterWrite(const Variable&, const Expr* index);
+    void noteArrayUse(const Variable&, SourcePos);
+    void checkOuterReads(ParallelLoop&);
+    bool makesNewArray(const Expr& value);
+    void checkArrayBinding(Type type, const Expr& value);
+    bool writesShared(const FunctionDecl*, std::unordered_set<const FunctionDecl*>& visited);
+    const uint32_t* readsGlobal(const FunctionDecl*, const std::vector<uint32_t>& slots, std::unordered_set<const FunctionDecl*>& visited);
+    void checkParallelCalls();
+};
@@ -0,0 +1,94 @@
+#include <cstring>
+#include <ostream>
+
+#include "Util/array.h"
+#include "Util/struct.h"
+
+RaftArray::RaftArray(ElementKind kind, size_t length, const RaftValue& fill) : kind(kind) {
+    switch (kind) {
+        case ElementKind::Int: elements = std::vector<int64_t>(length, std::get<int64_t>(fill)); break;
+        case ElementKind::Double: elements = std::vector<double>(length, std::get<double>(fill)); break;
+        case ElementKind::Bool: elements = std::vector<uint8_t>(length, std::get<bool>(fill)); break;
+        case ElementKind::String: elements = std::vector<std::string>(length, std::get<std::string>(fill)); break;
+        case ElementKind::Struct: {
+            const RaftStruct& value = *std::get<std::shared_ptr<RaftStruct>>(fill);
+            StructElements structs{ value.layout, std::vector<uint8_t>(length * value.layout->size) };
+
+            for (size_t i = 0; i < length; i++) std::memcpy(structs.bytes.data() + i * value.layout->size, value.bytes.data(), value.layout->size);
+            elements = std::move(structs);
+            break;
+        }
+    }
+}
+
+size_t RaftArray::size() const {
+    if (auto* structs = std::get_if<StructElements>(&elements)) return structs->bytes.size() / structs->layout->size;
+
+    return std::visit([](const auto& v) {
+        if constexpr (requires { v.size(); }) return v.size();
+        else return size_t{0};
+    }, elements);
+}
+
+uint8_t* RaftArray::structAt(size_t index) {
+    auto& structs = std::get<StructElements>(elements);
+    return structs.bytes.data() + index * structs.layout->size;
+}
+
+const uint8_t* RaftArray::structAt(size_t index) const {
+    const auto& structs = std::get<StructElements>(elements);
+    return structs.bytes.data() + index * structs.layout->size;
+}
+
+RaftValue RaftArray::get(size_t index) const {
+    switch (kind) {
+        case ElementKind::Int: return data<int64_t>()[index];
+        case ElementKind::Double: return data<double>()[index];
+        case ElementKind::Bool: return static_cast<bool>(data<uint8_t>()[index]);
+        case ElementKind::String: return data<std::string>()[index];
+        case ElementKind::Struct: return std::make_shared<RaftStruct>(std::get<StructElements>(elements).layout, structAt(index));
+    }
+
+    return std::monostate{};
+}
+
+// Ints stored into a double array are widened, as they are for double variables
+void RaftArray::set(size_t index, RaftValue value) {
+    switch (kind) {
+        case ElementKind::Int: data<int64_t>()[index] = std::get<int64_t>(value); break;
+        case ElementKind::Double:
+            if (auto* i = std::get_if<int64_t>(&value)) data<double>()[index] = static_cast<double>(*i);
+            else data<double>()[index] = std::get<double>(value);
+            break;
+        case ElementKind::Bool: data<uint8_t>()[index] = std::get<bool>(value); break;
+        case ElementKind::String: data<std::string>()[index] = std::move(std::get<std::string>(value)); break;
+        case ElementKind::Struct: {
+            const RaftStruct& element = *std::get<std::shared_ptr<RaftStruct>>(value);
+            std::memcpy(structAt(index), element.bytes.data(), element.layout->size);
+            break;
+        }
+    }
+}
+
+RaftValue defaultElement(ElementKind kind) {
+    switch (kind) {
+        case ElementKind::Int: return int64_t{0};
+        case ElementKind::Double: return 0.0;
+        case ElementKind::Bool: return false;
+        case ElementKind::String: return std::string();
+        case ElementKind::Struct: break;
+    }
+
+    return std::monostate{};
+}
+
+void printArray(std::ostream& out, const RaftArray& array) {
+    out << "[";
+
+    for (size_t i = 0; i < array.size(); i++) {
+        if (i > 0) out << ", ";
+        printValue(out, array.get(i));
+    }
+
+    out << "]";
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "Util/token.h"
+
+// Element types of arrays, in the order of RaftArray::elements
+enum class ElementKind : uint8_t {
+    Int,
+    Double,
+    Bool,
+    String,
+    Struct
+};
+
+struct StructLayout; // Util/struct.h
+
+// The elements of a struct array: whole structs back to back, each layout->size bytes
+struct StructElements {
+    const StructLayout* layout;
+    std::vector<uint8_t> bytes;
+};
+
+// A fixed-length Raft array (int[], double[], bool[], string[], Point[]). Elements are stored unboxed
+// in one contiguous buffer of their own type rather than as RaftValues. Arrays are shared by
+// reference: copying a RaftValue that holds one only copies the pointer.
+struct RaftArray {
+    ElementKind kind;
+
+    // bool elements are bytes so that they stay addressable (std::vector<bool> packs bits)
+    std::variant<
+        std::vector<int64_t>,
+        std::vector<double>,
+        std::vector<uint8_t>,
+        std::vector<std::string>,
+        StructElements
+    > elements;
+
+    // Every element starts as fill, which must already have the element type
+    RaftArray(ElementKind kind, size_t length, const RaftValue& fill);
+
+    // The bytes of a struct element, for reading and writing its fields in place
+    uint8_t* structAt(size_t index);
+    const uint8_t* structAt(size_t index) const;
+
+    size_t size() const;
+
+    RaftValue get(size_t index) const;
+    void set(size_t index, RaftValue value);
+
+    template<class T> std::vector<T>& data() { return std::get<std::vector<T>>(elements); }
+    template<class T> const std::vector<T>& data() const { return std::get<std::vector<T>>(elements); }
+};
+
+// The value elements of a new array start as: 0, 0.0, false or "" (struct arrays start from a value)
+RaftValue defaultElement(ElementKind);
+
+// Writes an array the way std.io.print shows it: [1, 2, 3]
+void printArray(std::ostream&, const RaftArray&);
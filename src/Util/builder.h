@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+
+// A std.string builder: text appended in place, so building a string piece by piece takes time
+// linear in its length rather than copying it for every piece as + does. Builders are shared by
+// reference like arrays.
+struct StringBuilder {
+    std::string text;
+};
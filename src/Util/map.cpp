@@ -0,0 +1,131 @@
+#include <ostream>
+#include <type_traits>
+
+#include "Util/map.h"
+
+namespace {
+    // A RaftValue as the key or value type of a table; ints are widened for double values
+    template<class T>
+    decltype(auto) unbox(const RaftValue& value) {
+        if constexpr (std::is_same_v<T, double>) {
+            auto* i = std::get_if<int64_t>(&value);
+            return i ? static_cast<double>(*i) : std::get<double>(value);
+        } else {
+            return std::get<T>(value);
+        }
+    }
+
+    // What array elements of type T are stored as (bool elements are bytes)
+    template<class T>
+    using Stored = std::conditional_t<std::is_same_v<T, bool>, uint8_t, T>;
+
+    template<class Table, size_t I = 0>
+    void emplaceTable(Table& table, size_t index) {
+        if constexpr (I < std::variant_size_v<Table>) {
+            if (I == index) table.template emplace<I>();
+            else emplaceTable<Table, I + 1>(table, index);
+        }
+    }
+
+    // Copies the keys (or values) of a table into a new array
+    template<class T, class Table, class Get>
+    std::shared_ptr<RaftArray> collect(ElementKind kind, const Table& table, Get get) {
+        auto out = std::make_shared<RaftArray>(kind, 0, defaultElement(kind));
+        auto& elements = out->data<Stored<T>>();
+        elements.reserve(table.size());
+
+        table.forEach([&](const auto& key, const auto& value) { elements.push_back(get(key, value)); });
+        return out;
+    }
+}
+
+// Tables are numbered key type first: int keys with int, double, bool and string values, then string keys
+RaftMap::RaftMap(ElementKind keyKind, ElementKind valueKind) : keyKind(keyKind), valueKind(valueKind) {
+    emplaceTable(table, (keyKind == ElementKind::String ? 4 : 0) + static_cast<size_t>(valueKind));
+}
+
+size_t RaftMap::size() const {
+    return std::visit([](const auto& t) { return t.size(); }, table);
+}
+
+bool RaftMap::get(const RaftValue& key, RaftValue& out) const {
+    return std::visit([&](const auto& t) {
+        using T = std::decay_t<decltype(t)>;
+
+        auto* value = t.find(unbox<typename T::key_type>(key));
+        if (!value) return false;
+
+        out = *value;
+        return true;
+    }, table);
+}
+
+bool RaftMap::contains(const RaftValue& key) const {
+    return std::visit([&](const auto& t) {
+        return t.contains(unbox<typename std::decay_t<decltype(t)>::key_type>(key));
+    }, table);
+}
+
+void RaftMap::set(const RaftValue& key, const RaftValue& value) {
+    std::visit([&](auto& t) {
+        using T = std::decay_t<decltype(t)>;
+        t.insert(unbox<typename T::key_type>(key)).first = unbox<typename T::mapped_type>(value);
+    }, table);
+}
+
+bool RaftMap::remove(const RaftValue& key) {
+    return std::visit([&](auto& t) {
+        return t.erase(unbox<typename std::decay_t<decltype(t)>::key_type>(key));
+    }, table);
+}
+
+void RaftMap::setAll(const RaftArray& keys, const RaftArray& values) {
+    std::visit([&](auto& t) {
+        using T = std::decay_t<decltype(t)>;
+        const auto& k = keys.data<typename T::key_type>();
+        const auto& v = values.data<Stored<typename T::mapped_type>>();
+
+        t.reserve(t.size() + k.size());
+        for (size_t i = 0; i < k.size(); i++) t.insert(k[i]).first = v[i];
+    }, table);
+}
+
+void RaftMap::reserve(size_t count) {
+    std::visit([&](auto& t) { t.reserve(count); }, table);
+}
+
+void RaftMap::clear() {
+    std::visit([](auto& t) { t.clear(); }, table);
+}
+
+std::shared_ptr<RaftArray> RaftMap::keys() const {
+    return std::visit([&](const auto& t) {
+        using K = typename std::decay_t<decltype(t)>::key_type;
+        return collect<K>(keyKind, t, [](const auto& key, const auto&) { return key; });
+    }, table);
+}
+
+std::shared_ptr<RaftArray> RaftMap::values() const {
+    return std::visit([&](const auto& t) {
+        using V = typename std::decay_t<decltype(t)>::mapped_type;
+        return collect<V>(valueKind, t, [](const auto&, const auto& value) { return value; });
+    }, table);
+}
+
+void printMap(std::ostream& out, const RaftMap& map) {
+    out << "{";
+
+    bool first = true;
+    std::visit([&](const auto& t) {
+        t.forEach([&](const auto& key, const auto& value) {
+            if (!first) out << ", ";
+            first = false;
+
+            printValue(out, key);
+            out << ": ";
+            printValue(out, value);
+        });
+    }, map.table);
+
+    out << "}";
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <variant>
+
+#include "Collections/SwissTable.h"
+#include "Util/token.h"
+#include "Util/array.h"
+
+// A Raft map (Map<string, int>): keys of one type (int or string) to values of one type (int,
+// double, bool or string), both stored unboxed in a Swiss table. Maps are shared by reference
+// like arrays. Values passed in must already have the value type, except that ints are widened
+// for double maps.
+struct RaftMap {
+    ElementKind keyKind;
+    ElementKind valueKind;
+
+    std::variant<
+        SwissTable<int64_t, int64_t>,
+        SwissTable<int64_t, double>,
+        SwissTable<int64_t, bool>,
+        SwissTable<int64_t, std::string>,
+        SwissTable<std::string, int64_t>,
+        SwissTable<std::string, double>,
+        SwissTable<std::string, bool>,
+        SwissTable<std::string, std::string>
+    > table;
+
+    RaftMap(ElementKind keyKind, ElementKind valueKind);
+
+    size_t size() const;
+
+    // Sets out to the key's value, or returns false when the map has no such key
+    bool get(const RaftValue& key, RaftValue& out) const;
+    bool contains(const RaftValue& key) const;
+
+    void set(const RaftValue& key, const RaftValue& value);
+    bool remove(const RaftValue& key);
+
+    // Inserts keys[i] -> values[i] for every i, after reserving room for all of them
+    void setAll(const RaftArray& keys, const RaftArray& values);
+
+    void reserve(size_t count);
+    void clear();
+
+    // The keys and the values, in the same order: values()[i] belongs to keys()[i]
+    std::shared_ptr<RaftArray> keys() const;
+    std::shared_ptr<RaftArray> values() const;
+};
+
+// Writes a map the way std.io.print shows it: {one: 1, two: 2}
+void printMap(std::ostream&, const RaftMap&);
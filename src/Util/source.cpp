@@ -0,0 +1,67 @@
+#include "Util/source.h"
+
+uint32_t SourceMap::openFile(const std::string& name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        files[it->second].positions.clear();
+        return it->second;
+    }
+
+    if (files.size() >= MaxFiles) return 0;
+
+    uint32_t id = static_cast<uint32_t>(files.size());
+    files.push_back(File{ name, {} });
+    ids.emplace(name, id);
+
+    return id;
+}
+
+SourcePos SourceMap::add(uint32_t file, uint32_t line, uint32_t column) {
+    if (file == 0) return 0;
+
+    auto& positions = files[file].positions;
+    if (positions.size() >= (1u << IndexBits)) return 0;
+
+    positions.push_back(SourceLocation{ line, column });
+    return (file << IndexBits) | static_cast<uint32_t>(positions.size() - 1);
+}
+
+const SourceLocation* SourceMap::locate(SourcePos pos) const {
+    uint32_t file = pos >> IndexBits;
+    uint32_t index = pos & ((1u << IndexBits) - 1);
+    if (file == 0 || file >= files.size() || index >= files[file].positions.size()) return nullptr;
+
+    return &files[file].positions[index];
+}
+
+std::string SourceMap::describe(SourcePos pos) const {
+    const SourceLocation* location = locate(pos);
+    if (!location) return "";
+
+    return files[pos >> IndexBits].name + ":" + std::to_string(location->line) + ":" + std::to_string(location->column);
+}
+
+std::string SourceMap::describeLine(SourcePos pos) const {
+    const SourceLocation* location = locate(pos);
+    if (!location) return "";
+
+    return files[pos >> IndexBits].name + ":" + std::to_string(location->line);
+}
+
+SourceMap& SourceMap::global() {
+    static SourceMap map;
+    return map;
+}
+
+void rethrowAt(SourcePos pos) {
+    try {
+        throw;
+    } catch (const LocatedError&) {
+        throw;
+    } catch (const std::runtime_error& e) {
+        std::string where = describePosition(pos);
+        if (where.empty()) throw;
+
+        throw LocatedError(where + ": " + e.what());
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Where an AST node came from, as a 32-bit handle: the file in the high bits and an index
+// into that file's position table in the low bits. 0 means unknown. Nodes only carry the
+// handle; lines and columns live in the SourceMap, away from the data the interpreter reads.
+using SourcePos = uint32_t;
+
+struct SourceLocation {
+    uint32_t line;
+    uint32_t column;
+};
+
+class SourceMap {
+public:
+    static constexpr uint32_t IndexBits = 20;
+    static constexpr uint32_t MaxFiles = 1u << (32 - IndexBits);
+
+    // Starts the table of a file. Opening a file again (it was re-parsed) reuses its id and
+    // drops its old positions, so a resident compiler doesn't grow with every edit.
+    uint32_t openFile(const std::string& name);
+
+    // Records a position, returning 0 once the file (or the number of files) is too large to encode
+    SourcePos add(uint32_t file, uint32_t line, uint32_t column);
+
+    // "main.rft:12:5", or empty for an unknown position
+    std::string describe(SourcePos) const;
+
+    // "main.rft:12", or empty for an unknown position
+    std::string describeLine(SourcePos) const;
+
+    // Process-wide map shared by the parser, checker, interpreter and profilers
+    static SourceMap& global();
+
+private:
+    struct File {
+        std::string name;
+        std::vector<SourceLocation> positions;
+    };
+
+    std::vector<File> files = { File{} }; // Id 0 is reserved for "no file"
+    std::unordered_map<std::string, uint32_t> ids;
+
+    const SourceLocation* locate(SourcePos) const;
+};
+
+inline uint32_t openSourceFile(const std::string& name) {
+    return SourceMap::global().openFile(name);
+}
+
+inline SourcePos sourcePosition(uint32_t file, uint32_t line, uint32_t column) {
+    return SourceMap::global().add(file, line, column);
+}
+
+inline std::string describePosition(SourcePos pos) {
+    return SourceMap::global().describe(pos);
+}
+
+// An error whose message already starts with where it happened
+class LocatedError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Called from a catch block: rethrows the current error prefixed with `pos`, unless it is
+// already located (an inner node knew better) or the position is unknown
+[[noreturn]] void rethrowAt(SourcePos pos);
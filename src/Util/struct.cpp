@@ -0,0 +1,71 @@
+#include <cstring>
+#include <memory>
+
+#include "Util/struct.h"
+
+const StructLayout::Field* StructLayout::field(Symbol fieldName) const {
+    for (const auto& f : fields) {
+        if (f.name == fieldName) return &f;
+    }
+
+    return nullptr;
+}
+
+RaftStruct::RaftStruct(const StructLayout* layout, const uint8_t* from) : layout(layout), bytes(layout->size) {
+    if (from) std::memcpy(bytes.data(), from, layout->size);
+}
+
+RaftValue readField(const uint8_t* at, ElementKind kind, const StructLayout* nested) {
+    switch (kind) {
+        case ElementKind::Int: {
+            int64_t value;
+            std::memcpy(&value, at, sizeof value);
+            return value;
+        }
+        case ElementKind::Double: {
+            double value;
+            std::memcpy(&value, at, sizeof value);
+            return value;
+        }
+        case ElementKind::Bool: return *at != 0;
+        case ElementKind::Struct: return std::make_shared<RaftStruct>(nested, at);
+        case ElementKind::String: break;
+    }
+
+    return std::monostate{};
+}
+
+// Ints stored into a double field are widened, as they are for double variables
+void writeField(uint8_t* at, ElementKind kind, const StructLayout* nested, const RaftValue& value) {
+    switch (kind) {
+        case ElementKind::Int: {
+            int64_t i = std::get<int64_t>(value);
+            std::memcpy(at, &i, sizeof i);
+            break;
+        }
+        case ElementKind::Double: {
+            auto* i = std::get_if<int64_t>(&value);
+            double d = i ? static_cast<double>(*i) : std::get<double>(value);
+            std::memcpy(at, &d, sizeof d);
+            break;
+        }
+        case ElementKind::Bool: *at = std::get<bool>(value); break;
+        case ElementKind::Struct: std::memcpy(at, std::get<std::shared_ptr<RaftStruct>>(value)->bytes.data(), nested->size); break;
+        case ElementKind::String: break;
+    }
+}
+
+void printStruct(std::ostream& out, const StructLayout& layout, const uint8_t* bytes) {
+    out << symbolName(layout.name) << "{";
+
+    for (size_t i = 0; i < layout.fields.size(); i++) {
+        const auto& f = layout.fields[i];
+        if (i > 0) out << ", ";
+
+        out << symbolName(f.name) << ": ";
+        if (f.kind == ElementKind::Struct) printStruct(out, *f.layout, bytes + f.offset);
+        else printValue(out, readField(bytes + f.offset, f.kind, nullptr));
+    }
+
+    out << "}";
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Util/token.h"
+#include "Util/symbol.h"
+#include "Util/array.h"
+
+// Where the fields of a struct type live in its values. Fields are laid out in declaration order,
+// each aligned to its size (8 bytes for ints and doubles, 1 for bools, a struct's own alignment for
+// a nested struct, which is stored inline). The Resolver computes layouts once the program's struct
+// declarations are known, and the TypeChecker bakes the offsets into the nodes that use them.
+struct StructLayout {
+    struct Field {
+        Symbol name;
+        ElementKind kind;                     // Int, Double, Bool or Struct
+        const StructLayout* layout = nullptr; // The nested struct's, for a Struct field
+        uint32_t offset = 0;
+    };
+
+    Symbol name;
+    uint32_t id = 0; // Declaration order, which numbers the struct types
+    std::vector<Field> fields;
+    uint32_t size = 0;
+    uint32_t align = 1;
+
+    const Field* field(Symbol) const;
+};
+
+// A struct value: the bytes of its fields, laid out as its layout says. Values are shared by
+// reference like arrays, but a struct variable copies its value before changing a field of one
+// that is shared, so structs behave as values.
+struct RaftStruct {
+    const StructLayout* layout;
+    std::vector<uint8_t> bytes;
+
+    // All fields zero, or copied from the bytes of another value of the same type
+    explicit RaftStruct(const StructLayout* layout, const uint8_t* from = nullptr);
+};
+
+// A field read from or written to the bytes of a struct at its offset
+RaftValue readField(const uint8_t* at, ElementKind, const StructLayout* nested);
+void writeField(uint8_t* at, ElementKind, const StructLayout* nested, const RaftValue&);
+
+// Writes a struct the way std.io.print shows it: Point{x: 1, y: 2.5}
+void printStruct(std::ostream&, const StructLayout&, const uint8_t* bytes);
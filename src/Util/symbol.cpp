@@ -0,0 +1,21 @@
+#include "Util/symbol.h"
+
+Symbol SymbolTable::intern(std::string_view name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+
+    Symbol id = static_cast<Symbol>(names.size());
+    const std::string& stored = names.emplace_back(name);
+    ids.emplace(std::string_view(stored), id);
+
+    return id;
+}
+
+const std::string& SymbolTable::name(Symbol id) const {
+    return names[id];
+}
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
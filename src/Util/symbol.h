@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Every identifier in Raft is interned once and handed around as a 32-bit Symbol
+// This makes name comparisons integer compares and keeps a single copy of each name
+using Symbol = uint32_t;
+
+class SymbolTable {
+public:
+    Symbol intern(std::string_view name);
+    const std::string& name(Symbol id) const;
+
+    // Process-wide table shared by the lexer, AST, Resolver and runtime
+    static SymbolTable& global();
+
+private:
+    std::deque<std::string> names; // deque keeps the strings (and the views into them) stable
+    std::unordered_map<std::string_view, Symbol> ids;
+};
+
+inline Symbol intern(std::string_view name) {
+    return SymbolTable::global().intern(name);
+}
+
+inline const std::string& symbolName(Symbol id) {
+    return SymbolTable::global().name(id);
+}
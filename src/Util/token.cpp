@@ -3,6 +3,11 @@
 #include <iostream>
 
 #include "Util/token.h"
+#include "Util/array.h"
+#include "Util/struct.h"
+#include "Util/map.h"
+#include "Util/builder.h"
+#include "IO/File.h"
 
 constexpr std::string_view to_string(TokenType token) {
     switch (token) {
@@ -10,8 +15,11 @@ constexpr std::string_view to_string(TokenType token) {
         case TokenType::RIGHT_PAREN:   return "RIGHT_PAREN";
         case TokenType::LEFT_BRACE:    return "LEFT_BRACE";
         case TokenType::RIGHT_BRACE:   return "RIGHT_BRACE";
+        case TokenType::LEFT_BRACKET:  return "LEFT_BRACKET";
+        case TokenType::RIGHT_BRACKET: return "RIGHT_BRACKET";
         case TokenType::COMMA:         return "COMMA";
         case TokenType::DOT:           return "DOT";
+        case TokenType::DOT_DOT:       return "DOT_DOT";
 
         case TokenType::MINUS:         return "MINUS";
         case TokenType::MINUS_EQUAL:   return "MINUS_EQUAL";
@@ -47,7 +55,9 @@ constexpr std::string_view to_string(TokenType token) {
         case TokenType::ELSE:          return "ELSE";
         case TokenType::WHILE:         return "WHILE";
         case TokenType::FOR:           return "FOR";
+        case TokenType::IN:            return "IN";
         case TokenType::LOOP:          return "LOOP";
+        case TokenType::STRUCT:        return "STRUCT";
         case TokenType::FN:            return "FN";
         case TokenType::BREAK:         return "BREAK";
         case TokenType::CONTINUE:      return "CONTINUE";
@@ -63,10 +73,36 @@ template<class... Ts> struct overload : Ts... { using Ts::operator()...; };
 
 void Token::dbPrint() const {
     std::visit(overload {
-        [this](std::monostate) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; },
+        [this](std::monostate) {
+            if (this->type == TokenType::IDENTIFIER) {
+                std::cout << "{" << to_string(this->type) << ", " << symbolName(this->symbol) << ", " << this->line << "}\n";
+                return;
+            }
+            std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n";
+        },
         [this](int64_t val) { std::cout << "{" << to_string(this->type) << ", " << val << ", " << this->line << "}\n"; },
         [this](double val) { std::cout << "{" << to_string(this->type) << ", " << val << ", " << this->line << "}\n"; },
         [this](bool val) { std::cout << "{" << to_string(this->type) << ", " << val << ", " << this->line << "}\n"; },
-        [this](const std::string& s) { std::cout << "{" << to_string(this->type) << ", " << s << ", " << this->line << "}\n"; }
+        [this](const std::string& s) { std::cout << "{" << to_string(this->type) << ", " << s << ", " << this->line << "}\n"; },
+        [this](const std::shared_ptr<RaftArray>&) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; },
+        [this](const std::shared_ptr<RaftStruct>&) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; },
+        [this](const std::shared_ptr<RaftMap>&) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; },
+        [this](const std::shared_ptr<StringBuilder>&) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; },
+        [this](const std::shared_ptr<RaftFile>&) { std::cout << "{" << to_string(this->type) << ", " << this->line << "}\n"; }
     }, value);
-}
\ No newline at end of file
+}
+
+void printValue(std::ostream& out, const RaftValue& value) {
+    std::visit(overload {
+        [&](std::monostate) { out << "None"; },
+        [&](int64_t val) { out << val; },
+        [&](double val) { out << val; },
+        [&](bool val) { out << (val ? "true" : "false"); },
+        [&](const std::string& s) { out << s; },
+        [&](const std::shared_ptr<RaftArray>& a) { printArray(out, *a); },
+        [&](const std::shared_ptr<RaftStruct>& s) { printStruct(out, *s->layout, s->bytes.data()); },
+        [&](const std::shared_ptr<RaftMap>& m) { printMap(out, *m); },
+        [&](const std::shared_ptr<StringBuilder>& b) { out << b->text; },
+        [&](const std::shared_ptr<RaftFile>& f) { printFile(out, *f); }
+    }, value);
+}
@@ -5,12 +5,15 @@
 #include <iostream>
 #include <variant>
 #include <cstdint>
+#include <memory>
+
+#include "Util/symbol.h"
 
 enum class TokenType {
     // Single-character tokens.
     LEFT_PAREN, RIGHT_PAREN, LEFT_BRACE, RIGHT_BRACE,
     LEFT_BRACKET, RIGHT_BRACKET,
-    COMMA, DOT, 
+    COMMA, DOT, DOT_DOT,
 
     MINUS,
     PLUS,
@@ -38,21 +41,32 @@ enum class TokenType {
     IDENTIFIER, STRING, DOUBLE, INT, BOOL,
 
     // Keywords.
-    LET, VAR, IF, ELSE, WHILE, FOR, LOOP, FN,
-    BREAK, CONTINUE, RETURN, IMPORT, MOD,
+    LET, VAR, IF, ELSE, WHILE, FOR, IN, LOOP, FN,
+    BREAK, CONTINUE, RETURN, IMPORT, MOD, STRUCT,
 
     EOFILE
 };
 
+struct RaftArray; // Util/array.h
+struct RaftStruct; // Util/struct.h
+struct RaftMap; // Util/map.h
+struct StringBuilder; // Util/builder.h
+class RaftFile; // IO/File.h
+
 // Every value in Raft is defined as a RaftValue
 // This will be extensively used everywhere including the lexer, parser and interpreter
-using RaftValue = std::variant<std::monostate, int64_t, double, std::string, bool>;
+using RaftValue = std::variant<std::monostate, int64_t, double, std::string, bool, std::shared_ptr<RaftArray>, std::shared_ptr<RaftStruct>, std::shared_ptr<RaftMap>, std::shared_ptr<StringBuilder>, std::shared_ptr<RaftFile>>;
+
+// Writes a value the way std.io.print shows it
+void printValue(std::ostream&, const RaftValue&);
 
 class Token {
 public:
     TokenType type;
     RaftValue value;
     int line;
+    uint32_t column = 0;
+    Symbol symbol = 0; // Interned name, only meaningful for identifiers
 
     Token(TokenType type, RaftValue value = std::monostate{}, int line = 0)
     : type(type), value(std::move(value)), line(line) {}
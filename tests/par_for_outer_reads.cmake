@@ -0,0 +1,79 @@
+# A par for body that stores into an outer array may only read that array at the loop counter,
+# directly or through a function; otherwise one iteration could copy a string another is
+# assigning. Reading its own element, or other arrays anywhere, still type checks.
+#
+# cmake -DRAFT=path/to/raft -P par_for_outer_reads.cmake
+
+# Each program gets a folder of its own, since the files next to a program load as its modules
+function(run_program name source)
+    set(dir "${CMAKE_CURRENT_BINARY_DIR}/par_for_outer_reads/${name}")
+    file(MAKE_DIRECTORY "${dir}")
+    file(WRITE "${dir}/main.rft" "${source}")
+
+    execute_process(
+        COMMAND "${RAFT}" main.rft
+        WORKING_DIRECTORY "${dir}"
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE output)
+
+    set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+run_program(mirrored [=[
+import std.io.*;
+
+fn main() {
+    let n = 4;
+    let var names = ["a", "b", "c", "d"];
+
+    par for i in 0..n {
+        names[i] = names[n - 1 - i] + "x";
+    }
+
+    println(names);
+}
+]=])
+
+if(NOT output MATCHES "stores into 'names' can only read it at the loop counter")
+    message(FATAL_ERROR "Reading another iteration's element should not type check:\n${output}")
+endif()
+
+run_program(through_function [=[
+import std.io.*;
+
+let var names = ["a", "b", "c", "d"];
+
+fn last() string { names[3] }
+
+fn main() {
+    par for i in 0..4 {
+        names[i] = last();
+    }
+
+    println(names);
+}
+]=])
+
+if(NOT output MATCHES "cannot call 'last', which reads 'names' while the loop stores into it")
+    message(FATAL_ERROR "Reading a stored global array through a function should not type check:\n${output}")
+endif()
+
+run_program(own_element [=[
+import std.io.*;
+
+fn main() {
+    let n = 4;
+    let var names = ["a", "b", "c", "d"];
+    let suffixes = ["w", "x", "y", "z"];
+
+    par for i in 0..n {
+        names[i] = names[i] + suffixes[n - 1 - i];
+    }
+
+    println(names);
+}
+]=])
+
+if(NOT output MATCHES "\\[az, by, cx, dw\\]")
+    message(FATAL_ERROR "Reading its own element and other arrays should still run:\n${output}")
+endif()
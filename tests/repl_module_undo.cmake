@@ -0,0 +1,29 @@
+# A REPL input that loads a module and then fails to type check is undone, module included. The
+# module must load again for the next input: my_file.sub_mod.sum(1, 2) has to print 3, not
+# "Cannot find".
+#
+# cmake -DRAFT=path/to/raft -DTEST_DIR=path/to/Test -P repl_module_undo.cmake
+
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/repl_module_undo.in"
+    "my_file.sub_mod.sum(1, \"x\")\n"
+    "my_file.sub_mod.sum(1, 2)\n")
+
+execute_process(
+    COMMAND "${RAFT}" --repl
+    WORKING_DIRECTORY "${TEST_DIR}"
+    INPUT_FILE "${CMAKE_CURRENT_BINARY_DIR}/repl_module_undo.in"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "raft --repl exited with ${result}:\n${output}")
+endif()
+
+if(NOT output MATCHES "expected int, got string")
+    message(FATAL_ERROR "The first input should fail to type check:\n${output}")
+endif()
+
+if(output MATCHES "Cannot find" OR NOT output MATCHES "raft> 3\n")
+    message(FATAL_ERROR "The module was not loaded again after the failed input was undone:\n${output}")
+endif()
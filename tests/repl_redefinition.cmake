@@ -0,0 +1,36 @@
+# A REPL input can redefine a function, but only with the parameter and return types that earlier
+# inputs were checked against: g still calls f(1) after the rejected redefinition, and runs the
+# accepted one.
+#
+# cmake -DRAFT=path/to/raft -P repl_redefinition.cmake
+
+set(dir "${CMAKE_CURRENT_BINARY_DIR}/repl_redefinition")
+file(MAKE_DIRECTORY "${dir}")
+
+file(WRITE "${dir}/input"
+    "fn f(a: int) int { a }\n"
+    "fn g() int { f(1) }\n"
+    "fn f(a: int[], b: int) int { b }\n"
+    "g()\n"
+    "fn f(a: int) int { a + 1 }\n"
+    "g()\n")
+
+execute_process(
+    COMMAND "${RAFT}" --repl
+    WORKING_DIRECTORY "${dir}"
+    INPUT_FILE "${dir}/input"
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "raft --repl exited with ${result}:\n${output}")
+endif()
+
+if(NOT output MATCHES "Cannot redefine f as \\(int\\[\\], int\\) int: earlier inputs call it as \\(int\\) int")
+    message(FATAL_ERROR "The redefinition with other parameter types should be rejected:\n${output}")
+endif()
+
+if(NOT output MATCHES "raft> 1\n" OR NOT output MATCHES "raft> 2\n")
+    message(FATAL_ERROR "g should run the old f, then the redefinition with the same types:\n${output}")
+endif()